@@ -8,11 +8,29 @@
 // warranty, and with no claim as to its suitability for any purpose.
 //
 
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <ctype.h>
+#include <deque>
+#include <float.h>
 #include <iterator>
+#include <limits>
 #include <map>
+#include <math.h>
 #include <memory>
+#include <set>
 #include <sstream>
-
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unordered_map>
+
+// the TclOO API is not exported by the Tcl library,
+// so it is always used through its stubs table (see init_oo_stubs)
+#ifndef USE_TCLOO_STUBS
+#define USE_TCLOO_STUBS
+#endif
 #include "cpptcl/cpptcl.h"
 
 using namespace Tcl;
@@ -77,25 +95,623 @@ result::operator string() const {
 
 result::operator object() const { return object(Tcl_GetObjResult(interp_)); }
 
-void details::set_result(Tcl_Interp *interp, bool b) { Tcl_SetObjResult(interp, Tcl_NewBooleanObj(b)); }
+Tcl_Obj *details::make_obj(bool b) noexcept { return Tcl_NewBooleanObj(b); }
+
+Tcl_Obj *details::make_obj(int i) noexcept { return Tcl_NewIntObj(i); }
+
+Tcl_Obj *details::make_obj(long i) noexcept { return Tcl_NewLongObj(i); }
+
+namespace {
+
+// the string rep of a double is made right away, since the results
+// are usually written out
+void set_double_string(Tcl_Obj *obj, double d) noexcept {
+	char buf[TCL_DOUBLE_SPACE];
+	int len = format_double(d, buf);
+	obj->bytes = Tcl_Alloc(len + 1);
+	memcpy(obj->bytes, buf, len + 1);
+	obj->length = len;
+}
+
+} // namespace
+
+// Tcl_PrintDouble gives the shortest digits too (unless tcl_precision
+// is set), but std::to_chars finds them much faster
+int details::format_double(double d, char *buf) noexcept {
+#if defined(__cpp_lib_to_chars)
+	if (!isfinite(d)) {
+		Tcl_PrintDouble(0, d, buf);
+		return static_cast<int>(strlen(buf));
+	}
+
+	// [-]D[.DDD]e(+|-)XX
+	char sci[32];
+	char const *end = to_chars(sci, sci + sizeof(sci), d, chars_format::scientific).ptr;
+	char const *p = sci;
+	char *dst = buf;
+	if (*p == '-') {
+		*dst++ = *p++;
+	}
+
+	char digits[20];
+	int n = 0;
+	digits[n++] = *p++;
+	if (*p == '.') {
+		for (++p; *p != 'e'; ++p) {
+			digits[n++] = *p;
+		}
+	}
+	++p;
+	int exponent = 0;
+	from_chars(*p == '+' ? p + 1 : p, end, exponent);
+
+	if (exponent < -4 || exponent > 16) {
+		*dst++ = digits[0];
+		if (n > 1) {
+			*dst++ = '.';
+			memcpy(dst, digits + 1, n - 1);
+			dst += n - 1;
+		}
+		*dst++ = 'e';
+		*dst++ = exponent < 0 ? '-' : '+';
+		dst = to_chars(dst, dst + 4, exponent < 0 ? -exponent : exponent).ptr;
+	} else if (exponent < 0) {
+		*dst++ = '0';
+		*dst++ = '.';
+		for (int k = -1; k > exponent; --k) {
+			*dst++ = '0';
+		}
+		memcpy(dst, digits, n);
+		dst += n;
+	} else {
+		for (int k = 0; k <= exponent; ++k) {
+			*dst++ = k < n ? digits[k] : '0';
+		}
+		*dst++ = '.';
+		if (n > exponent + 1) {
+			memcpy(dst, digits + exponent + 1, n - exponent - 1);
+			dst += n - exponent - 1;
+		} else {
+			*dst++ = '0';
+		}
+	}
+
+	*dst = '\0';
+	return static_cast<int>(dst - buf);
+#else
+	Tcl_PrintDouble(0, d, buf);
+	return static_cast<int>(strlen(buf));
+#endif
+}
+
+Tcl_Obj *details::make_obj(double d) noexcept { return Tcl_NewDoubleObj(d); }
+
+Tcl_Obj *details::make_double_list_obj(double const *values, size_t n) noexcept {
+	vector<Tcl_Obj *> elems(n);
+	for (size_t i = 0; i != n; ++i) {
+		elems[i] = Tcl_NewDoubleObj(values[i]);
+	}
+
+	Tcl_Obj *res = Tcl_NewListObj(static_cast<Tcl_Size>(n), elems.data());
+
+	// lists too long for a single buffer get their string form from Tcl
+	if (n == 0 || n > static_cast<size_t>(TCL_SIZE_MAX) / TCL_DOUBLE_SPACE) {
+		return res;
+	}
+
+	// the numbers need no quoting, so the list is just the numbers
+	// separated by spaces
+	char *buf = Tcl_Alloc(n * TCL_DOUBLE_SPACE);
+	char *dst = buf;
+	for (size_t i = 0; i != n; ++i) {
+		dst += format_double(values[i], dst);
+		*dst++ = ' ';
+	}
+	*--dst = '\0';
+
+	res->length = static_cast<Tcl_Size>(dst - buf);
+	res->bytes = Tcl_Realloc(buf, res->length + 1);
+	return res;
+}
+
+Tcl_Obj *details::make_wide_obj(Tcl_WideInt i) noexcept { return Tcl_NewWideIntObj(i); }
+
+Tcl_Obj *details::make_unsigned_wide_obj(Tcl_WideUInt i) noexcept {
+	if (i <= static_cast<Tcl_WideUInt>(std::numeric_limits<Tcl_WideInt>::max())) {
+		return Tcl_NewWideIntObj(static_cast<Tcl_WideInt>(i));
+	}
+
+	// Tcl reads this back as a big integer
+	char buf[24];
+	int len = 0;
+	char *p = buf + sizeof(buf);
+	do {
+		*--p = static_cast<char>('0' + i % 10);
+		i /= 10;
+		++len;
+	} while (i != 0);
+
+	return Tcl_NewStringObj(p, len);
+}
+
+Tcl_Obj *details::make_obj(string const &s) noexcept { return Tcl_NewStringObj(s.data(), static_cast<int>(s.size())); }
+
+Tcl_Obj *details::make_obj(string_view s) noexcept { return Tcl_NewStringObj(s.data(), static_cast<int>(s.size())); }
+
+Tcl_Obj *details::make_obj(char const *s) noexcept { return Tcl_NewStringObj(s, -1); }
+
+Tcl_Obj *details::make_obj(object const &o) noexcept { return o.get_object(); }
+
+Tcl_Obj *details::make_obj(const_byte_span s) noexcept { return Tcl_NewByteArrayObj(s.data(), static_cast<int>(s.size())); }
+
+Tcl_Obj *details::make_obj(byte_span const &s) noexcept { return s.get_object() != 0 ? s.get_object() : Tcl_NewByteArrayObj(0, 0); }
+
+Tcl_Obj *details::make_obj(result_writer const &w) noexcept { return w.get_object() != 0 ? w.get_object() : Tcl_NewObj(); }
+
+namespace {
+
+atomic<size_t> constant_count(0);
+
+// shared result objects of one interpreter, created on first use
+struct result_cache {
+	static int const small_min = -1;
+	static int const small_max = 255;
+
+	result_cache() { fill(ints_, ints_ + (small_max - small_min + 1), static_cast<Tcl_Obj *>(0)); }
+
+	~result_cache() {
+		for (Tcl_Obj *o : ints_) {
+			if (o != 0) {
+				Tcl_DecrRefCount(o);
+			}
+		}
+		for (Tcl_Obj *o : constants_) {
+			if (o != 0) {
+				Tcl_DecrRefCount(o);
+			}
+		}
+	}
+
+	Tcl_Obj *small_int(int i) {
+		Tcl_Obj *&o = ints_[i - small_min];
+		if (o == 0) {
+			o = Tcl_NewIntObj(i);
+			Tcl_IncrRefCount(o);
+		}
+		return o;
+	}
+
+	Tcl_Obj *constant(constant_string const &s) {
+		if (s.index() >= constants_.size()) {
+			constants_.resize(s.index() + 1, 0);
+		}
+
+		Tcl_Obj *&o = constants_[s.index()];
+		if (o == 0) {
+			o = make_obj(s);
+			Tcl_IncrRefCount(o);
+		}
+		return o;
+	}
+
+	Tcl_Obj *ints_[small_max - small_min + 1];
+	vector<Tcl_Obj *> constants_;
+};
+
+// the cache of the last interpreter is remembered,
+// so that the assoc data is looked up only when it changes
+thread_local Tcl_Interp *last_cache_interp = 0;
+thread_local result_cache *last_cache = 0;
+
+extern "C" void delete_result_cache(ClientData cd, Tcl_Interp *interp) {
+	if (last_cache_interp == interp) {
+		last_cache_interp = 0;
+		last_cache = 0;
+	}
+	delete static_cast<result_cache *>(cd);
+}
+
+result_cache &get_result_cache(Tcl_Interp *interp) {
+	if (interp != last_cache_interp) {
+		result_cache *c = static_cast<result_cache *>(Tcl_GetAssocData(interp, "cpptcl::results", 0));
+		if (c == 0) {
+			c = new result_cache();
+			Tcl_SetAssocData(interp, "cpptcl::results", delete_result_cache, c);
+		}
+
+		last_cache_interp = interp;
+		last_cache = c;
+	}
+
+	return *last_cache;
+}
+
+// the result object, when nobody else refers to it
+Tcl_Obj *unshared_result(Tcl_Interp *interp) {
+	Tcl_Obj *res = Tcl_GetObjResult(interp);
+	return Tcl_IsShared(res) ? 0 : res;
+}
+
+void set_int_result(Tcl_Interp *interp, int i) noexcept {
+	if (Tcl_Obj *res = unshared_result(interp)) {
+		Tcl_SetIntObj(res, i);
+	} else if (i >= result_cache::small_min && i <= result_cache::small_max) {
+		Tcl_SetObjResult(interp, get_result_cache(interp).small_int(i));
+	} else {
+		Tcl_SetObjResult(interp, Tcl_NewIntObj(i));
+	}
+}
+
+// (not when the string is in the result itself, which is freed first)
+void set_string_result(Tcl_Interp *interp, char const *s, size_t len) noexcept {
+	Tcl_Obj *res = unshared_result(interp);
+	if (res != 0 && (res->bytes == 0 || s < res->bytes || s > res->bytes + res->length)) {
+		Tcl_SetStringObj(res, s, static_cast<int>(len));
+	} else {
+		Tcl_SetObjResult(interp, Tcl_NewStringObj(s, static_cast<int>(len)));
+	}
+}
+
+} // namespace
+
+constant_string::constant_string(string s) : str_(std::move(s)), index_(constant_count++) {}
+
+Tcl_Obj *details::make_obj(constant_string const &s) noexcept { return make_obj(s.str()); }
+
+void details::set_result(Tcl_Interp *interp, bool b) noexcept { set_int_result(interp, b ? 1 : 0); }
+
+void details::set_result(Tcl_Interp *interp, int i) noexcept { set_int_result(interp, i); }
+
+void details::set_result(Tcl_Interp *interp, long i) noexcept {
+	if (i >= result_cache::small_min && i <= result_cache::small_max) {
+		set_int_result(interp, static_cast<int>(i));
+	} else if (Tcl_Obj *res = unshared_result(interp)) {
+		Tcl_SetLongObj(res, i);
+	} else {
+		Tcl_SetObjResult(interp, make_obj(i));
+	}
+}
+
+void details::set_result(Tcl_Interp *interp, double d) noexcept {
+	Tcl_Obj *res = unshared_result(interp);
+	if (res != 0) {
+		Tcl_SetDoubleObj(res, d);
+	} else {
+		res = make_obj(d);
+		Tcl_SetObjResult(interp, res);
+	}
+	set_double_string(res, d);
+}
+
+void details::set_result(Tcl_Interp *interp, string const &s) noexcept { set_string_result(interp, s.data(), s.size()); }
+
+void details::set_result(Tcl_Interp *interp, constant_string const &s) noexcept { Tcl_SetObjResult(interp, get_result_cache(interp).constant(s)); }
+
+void details::set_result(Tcl_Interp *interp, const_byte_span s) noexcept { Tcl_SetObjResult(interp, make_obj(s)); }
+
+void details::set_result(Tcl_Interp *interp, byte_span const &s) noexcept { Tcl_SetObjResult(interp, make_obj(s)); }
+
+void details::set_result(Tcl_Interp *interp, result_writer const &w) noexcept { Tcl_SetObjResult(interp, make_obj(w)); }
+
+void details::set_result(Tcl_Interp *interp, string_view s) noexcept { set_string_result(interp, s.data(), s.size()); }
+
+void details::set_result(Tcl_Interp *interp, char const *s) noexcept { set_string_result(interp, s, strlen(s)); }
+
+void details::set_result(Tcl_Interp *interp, void *p) { Tcl_SetObjResult(interp, new_pointer_handle(p, 0)); }
+
+void details::set_result(Tcl_Interp *interp, object const &o) noexcept { Tcl_SetObjResult(interp, make_obj(o)); }
+
+namespace // anonymous
+{
+
+// entry describing a single pointer known to Tcl
+// - the entry lives as long as there are Tcl objects that refer to it,
+//   or, for objects owned by classes, until the object is deleted
+// - the entries of deleted objects are no longer live, so that the
+//   handles that still refer to them are rejected
+struct handle_entry {
+	void *ptr_;
+	void const *tag_;
+	size_t refs_;
+	bool live_;
+	bool owned_;
+};
+
+typedef unordered_map<void *, handle_entry *> handle_map;
+
+// the handles of the thread, as Tcl objects belong to one thread
+// - class_tags_ are the types of the classes, whose live objects
+//   are all known, so that other pointers of these types are rejected
+struct handle_registry {
+	handle_map handles_;
+	deque<handle_entry> pool_;
+	vector<handle_entry *> free_;
+	set<void const *> class_tags_;
+};
+
+thread_local handle_registry *registry_ = 0;
+
+extern "C" void delete_handle_registry(ClientData) {
+	delete registry_;
+	registry_ = 0;
+}
+
+handle_registry &registry() {
+	if (registry_ == 0) {
+		registry_ = new handle_registry;
+		Tcl_CreateThreadExitHandler(delete_handle_registry, 0);
+	}
+	return *registry_;
+}
+
+// the type tag is given when the entry is created
+// (later results may give the same pointer as one of its base classes)
+handle_entry *find_handle_entry(void *p, void const *tag) {
+	handle_registry &r = registry();
+	handle_map::iterator it = r.handles_.find(p);
+	if (it != r.handles_.end()) {
+		if (it->second->tag_ == 0) {
+			it->second->tag_ = tag;
+		}
+		return it->second;
+	}
+
+	handle_entry *e;
+	if (r.free_.empty()) {
+		handle_entry ne = {0, 0, 0, false, false};
+		r.pool_.push_back(ne);
+		e = &r.pool_.back();
+	} else {
+		e = r.free_.back();
+		r.free_.pop_back();
+	}
+
+	e->ptr_ = p;
+	e->tag_ = tag;
+	e->refs_ = 0;
+	e->live_ = true;
+	e->owned_ = false;
+	r.handles_[p] = e;
+	return e;
+}
+
+// returns the entry to the pool, when nothing keeps it any longer
+void retire_handle_entry(handle_entry *e) {
+	if (e->refs_ != 0 || e->owned_) {
+		return;
+	}
+
+	handle_registry &r = registry();
+	if (e->live_) {
+		r.handles_.erase(e->ptr_);
+		e->live_ = false;
+	}
+	r.free_.push_back(e);
+}
+
+// formats the pointer in the 'pXXX' form, returns the length
+int format_handle(void *p, char *buf) {
+	uintptr_t v = reinterpret_cast<uintptr_t>(p);
+	if (v == 0) {
+		buf[0] = 'p';
+		buf[1] = '0';
+		buf[2] = '\0';
+		return 2;
+	}
+
+	static char const digits[] = "0123456789abcdef";
+	char tmp[2 * sizeof(uintptr_t)];
+	int n = 0;
+	for (; v != 0; v >>= 4) {
+		tmp[n++] = digits[v & 0xf];
+	}
+
+	int len = 0;
+	buf[len++] = 'p';
+	buf[len++] = '0';
+	buf[len++] = 'x';
+	while (n != 0) {
+		buf[len++] = tmp[--n];
+	}
+	buf[len] = '\0';
+	return len;
+}
+
+// duplicates internal reps that do not own any memory
+extern "C" void dup_intrep_proc(Tcl_Obj *src, Tcl_Obj *dup) {
+	dup->internalRep = src->internalRep;
+	dup->typePtr = src->typePtr;
+}
+
+extern "C" void free_handle_proc(Tcl_Obj *obj) {
+	// the registry is gone only when the thread is finalized
+	if (registry_ == 0) {
+		return;
+	}
+
+	handle_entry *e = static_cast<handle_entry *>(obj->internalRep.twoPtrValue.ptr1);
+	--e->refs_;
+	retire_handle_entry(e);
+}
+
+extern "C" void dup_handle_proc(Tcl_Obj *src, Tcl_Obj *dup) {
+	handle_entry *e = static_cast<handle_entry *>(src->internalRep.twoPtrValue.ptr1);
+	++e->refs_;
+	dup->internalRep.twoPtrValue.ptr1 = e;
+	dup->typePtr = src->typePtr;
+}
+
+extern "C" void update_handle_string_proc(Tcl_Obj *obj) {
+	handle_entry *e = static_cast<handle_entry *>(obj->internalRep.twoPtrValue.ptr1);
+
+	char buf[4 + 2 * sizeof(uintptr_t)];
+	int len = format_handle(e->ptr_, buf);
+
+	obj->bytes = Tcl_Alloc(len + 1);
+	memcpy(obj->bytes, buf, len + 1);
+	obj->length = len;
+}
+
+extern "C" int set_handle_from_any_proc(Tcl_Interp *interp, Tcl_Obj *obj);
+
+Tcl_ObjType handle_type = {
+	const_cast<char *>("cpptcl::handle"), // name
+	free_handle_proc,					 // freeIntRepProc
+	dup_handle_proc,					 // dupIntRepProc
+	update_handle_string_proc,			 // updateStringProc
+	set_handle_from_any_proc			 // setFromAnyProc
+};
+
+void set_handle_rep(Tcl_Obj *obj, handle_entry *e) {
+	// the new reference is counted first, as the old internal rep
+	// can be the last one that refers to the same entry
+	++e->refs_;
+	if (obj->typePtr != 0 && obj->typePtr->freeIntRepProc != 0) {
+		obj->typePtr->freeIntRepProc(obj);
+	}
+
+	obj->internalRep.twoPtrValue.ptr1 = e;
+	obj->typePtr = &handle_type;
+}
+
+char const *parse_handle(Tcl_Obj *obj, void *&p) {
+	Tcl_Size len;
+	char const *s = Tcl_GetStringFromObj(obj, &len);
+	if (len == 0) {
+		return "Expected pointer value, got empty string.";
+	}
+
+	if (s[0] != 'p' || len == 1) {
+		return "Expected pointer value.";
+	}
+
+	char *end;
+	unsigned long long v = strtoull(s + 1, &end, 16);
+	if (end != s + len || s[1] == '-' || s[1] == '+') {
+		return "Expected pointer value.";
+	}
+
+	p = reinterpret_cast<void *>(static_cast<uintptr_t>(v));
+	return 0;
+}
+
+extern "C" int set_handle_from_any_proc(Tcl_Interp *interp, Tcl_Obj *obj) {
+	void *p;
+	char const *err = parse_handle(obj, p);
+	if (err != 0) {
+		if (interp != 0) {
+			Tcl_SetObjResult(interp, Tcl_NewStringObj(err, -1));
+		}
+		return TCL_ERROR;
+	}
+
+	// pointers that were never seen before are not typed
+	set_handle_rep(obj, find_handle_entry(p, 0));
+	return TCL_OK;
+}
+
+} // namespace
+
+Tcl_Obj *details::new_pointer_handle(void *p, void const *tag) {
+	handle_entry *e = find_handle_entry(p, tag);
+
+	char buf[4 + 2 * sizeof(uintptr_t)];
+	int len = format_handle(p, buf);
+
+	Tcl_Obj *obj = Tcl_NewStringObj(buf, len);
+	set_handle_rep(obj, e);
+	return obj;
+}
+
+namespace // anonymous
+{
+
+// finds the pointer given by the handle
+// - returns 0 or the error message; when named is set,
+//   the message is to be prefixed with "Object <handle>"
+char const *lookup_handle(Tcl_Obj *obj, void const *tag, bool exact, void *&p, bool &named) {
+	named = false;
+	if (obj->typePtr != &handle_type) {
+		char const *err = parse_handle(obj, p);
+		if (err != 0) {
+			return err;
+		}
+
+		// all the live objects of the classes are known, so other
+		// pointers of their types are copies of deleted handles
+		handle_registry &r = registry();
+		if (tag != 0 && r.class_tags_.count(tag) != 0 && r.handles_.find(p) == r.handles_.end()) {
+			named = true;
+			return " does not exist.";
+		}
+
+		set_handle_rep(obj, find_handle_entry(p, 0));
+	}
+
+	handle_entry *e = static_cast<handle_entry *>(obj->internalRep.twoPtrValue.ptr1);
+	if (!e->live_) {
+		named = true;
+		return " was deleted.";
+	}
+
+	if (exact && tag != 0 && e->tag_ != 0 && e->tag_ != tag) {
+		named = true;
+		return " has wrong type.";
+	}
+
+	p = e->ptr_;
+	return 0;
+}
+
+} // namespace
+
+void *details::get_pointer_handle(Tcl_Obj *obj, void const *tag, bool exact) {
+	void *p;
+	bool named;
+	char const *err = lookup_handle(obj, tag, exact, p, named);
+	if (err != 0) {
+		throw tcl_error(named ? string("Object ") + Tcl_GetString(obj) + err : string(err));
+	}
+
+	return p;
+}
 
-void details::set_result(Tcl_Interp *interp, int i) { Tcl_SetObjResult(interp, Tcl_NewIntObj(i)); }
+int details::get_pointer_handle(Tcl_Interp *interp, Tcl_Obj *obj, void const *tag, void *&p, bool exact) noexcept {
+	bool named;
+	char const *err = lookup_handle(obj, tag, exact, p, named);
+	if (err != 0) {
+		if (interp != 0) {
+			Tcl_SetObjResult(interp, named ? Tcl_ObjPrintf("Object %s%s", Tcl_GetString(obj), err) : Tcl_NewStringObj(err, -1));
+		}
+		return TCL_ERROR;
+	}
 
-void details::set_result(Tcl_Interp *interp, long i) { Tcl_SetObjResult(interp, Tcl_NewLongObj(i)); }
+	return TCL_OK;
+}
 
-void details::set_result(Tcl_Interp *interp, double d) { Tcl_SetObjResult(interp, Tcl_NewDoubleObj(d)); }
+void details::own_pointer_handle(Tcl_Obj *obj, void const *tag) {
+	get_pointer_handle(obj, 0);
 
-void details::set_result(Tcl_Interp *interp, string const &s) { Tcl_SetObjResult(interp, Tcl_NewStringObj(s.data(), static_cast<int>(s.size()))); }
+	handle_entry *e = static_cast<handle_entry *>(obj->internalRep.twoPtrValue.ptr1);
+	e->tag_ = tag;
+	e->owned_ = true;
+}
 
-void details::set_result(Tcl_Interp *interp, void *p) {
-	ostringstream ss;
-	ss << 'p' << p;
-	string s(ss.str());
+void details::release_pointer_handle(void *p) {
+	handle_registry &r = registry();
+	handle_map::iterator it = r.handles_.find(p);
+	if (it == r.handles_.end()) {
+		return;
+	}
 
-	Tcl_SetObjResult(interp, Tcl_NewStringObj(s.data(), static_cast<int>(s.size())));
+	handle_entry *e = it->second;
+	r.handles_.erase(it);
+	e->live_ = false;
+	e->owned_ = false;
+	retire_handle_entry(e);
 }
 
-void details::set_result(Tcl_Interp *interp, object const &o) { Tcl_SetObjResult(interp, o.get_object()); }
+void details::add_class_tag(void const *tag) { registry().class_tags_.insert(tag); }
 
 void details::check_params_no(int objc, int required, const std::string &message) {
 	if (objc < required) {
@@ -103,6 +719,11 @@ void details::check_params_no(int objc, int required, const std::string &message
 	}
 }
 
+int details::params_no_error(Tcl_Interp *interp, const std::string &message) noexcept {
+	Tcl_SetObjResult(interp, Tcl_NewStringObj(message.data(), static_cast<int>(message.size())));
+	return TCL_ERROR;
+}
+
 object details::get_var_params(Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[], int from, policies const &pol) {
 	object o;
 
@@ -121,18 +742,30 @@ object details::get_var_params(Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv
 namespace // anonymous
 {
 
-// map of polymorphic callbacks
-typedef map<string, shared_ptr<callback_base>> callback_interp_map;
-typedef map<Tcl_Interp *, callback_interp_map> callback_map;
+// record of a single constructor command
+// - it is given to Tcl as the ClientData of the command,
+//   so that dispatching the call does not need any lookup
+struct callback_record {
+	callback_record(shared_ptr<callback_base> cb, policies const &pol, shared_ptr<class_handler_base> chb = shared_ptr<class_handler_base>()) : cb_(cb), pol_(pol), chb_(chb) {}
 
-callback_map callbacks;
-callback_map constructors;
+	shared_ptr<callback_base> cb_;
+	policies pol_;
 
-// map of call policies
-typedef map<string, policies> policies_interp_map;
-typedef map<Tcl_Interp *, policies_interp_map> policies_map;
+	// class handler for the objects created by a constructor
+	shared_ptr<class_handler_base> chb_;
+};
 
-policies_map call_policies;
+extern "C" void callback_record_delete(ClientData cd) { delete static_cast<callback_record *>(cd); }
+
+extern "C" void function_record_delete(ClientData cd) { delete static_cast<function_record *>(cd); }
+
+// names of the commands defined in each interpreter
+// (the records themselves are owned by the Tcl commands)
+typedef set<string> command_names;
+typedef map<Tcl_Interp *, command_names> command_names_map;
+
+command_names_map callbacks;
+command_names_map constructors;
 
 // map of object handlers
 typedef map<string, shared_ptr<class_handler_base>> class_interp_map;
@@ -140,24 +773,35 @@ typedef map<Tcl_Interp *, class_interp_map> class_handlers_map;
 
 class_handlers_map class_handlers;
 
-// helper for finding call policies - returns true when found
-bool find_policies(Tcl_Interp *interp, string const &cmdName, policies_interp_map::iterator &piti) {
-	policies_map::iterator pit = call_policies.find(interp);
+extern "C" int object_handler(ClientData cd, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[]);
 
-	if (pit == call_policies.end()) {
-		return false;
-	}
+// record of a single object command
+// - it is given to Tcl as the ClientData of the command
+struct object_record {
+	object_record(class_handler_base *chb, void *p) : chb_(chb), p_(p), token_(0) {}
 
-	piti = pit->second.find(cmdName);
-	return piti != pit->second.end();
-}
+	class_handler_base *chb_;
+	void *p_;
+	Tcl_Command token_;
+};
 
-extern "C" int object_handler(ClientData cd, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[]);
+extern "C" void object_record_delete(ClientData cd) { delete static_cast<object_record *>(cd); }
+
+// registers a new command for the object that is the current result
+// - the result is a pointer handle in the 'pXXX' form,
+//   which is also the name of the new command
+void create_object_command(Tcl_Interp *interp, class_handler_base *chb) {
+	Tcl_Obj *res = Tcl_GetObjResult(interp);
+	own_pointer_handle(res, chb->tag());
+	object_record *rec = new object_record(chb, get_pointer_handle(res, 0));
+
+	rec->token_ = Tcl_CreateObjCommand(interp, Tcl_GetString(res), object_handler, static_cast<ClientData>(rec), object_record_delete);
+}
 
 // helper function for post-processing call policies
 // for both free functions (isMethod == false)
 // and class methods (isMethod == true)
-void post_process_policies(Tcl_Interp *interp, policies &pol, Tcl_Obj *CONST objv[], bool isMethod) {
+void post_process_policies(Tcl_Interp *interp, policies const &pol, Tcl_Obj *CONST objv[], bool isMethod) {
 	// check if it is a factory
 	if (!pol.factory_.empty()) {
 		class_handlers_map::iterator it = class_handlers.find(interp);
@@ -178,13 +822,18 @@ void post_process_policies(Tcl_Interp *interp, policies &pol, Tcl_Obj *CONST obj
 		// if everything went OK, the result is the address of the
 		// new object in the 'pXXX' form
 		// - the new command will be created with this name
+		// - classes in handle mode do not need any command
 
-		Tcl_CreateObjCommand(interp, Tcl_GetString(Tcl_GetObjResult(interp)), object_handler, static_cast<ClientData>(chb), 0);
+		if (!chb->handle_mode()) {
+			create_object_command(interp, chb);
+		} else {
+			own_pointer_handle(Tcl_GetObjResult(interp), chb->tag());
+		}
 	}
 
 	// process all declared sinks
 	// - unregister all object commands that envelopes the pointers
-	for (vector<int>::iterator s = pol.sinks_.begin(); s != pol.sinks_.end(); ++s) {
+	for (vector<int>::const_iterator s = pol.sinks_.begin(); s != pol.sinks_.end(); ++s) {
 		if (isMethod == false) {
 			// example: if there is a declared sink at parameter 3,
 			// and the Tcl command was:
@@ -192,6 +841,7 @@ void post_process_policies(Tcl_Interp *interp, policies &pol, Tcl_Obj *CONST obj
 			// then the index 3 correctly points into the objv array
 
 			int index = *s;
+			release_pointer_handle(get_pointer_handle(objv[index], 0));
 			Tcl_DeleteCommand(interp, Tcl_GetString(objv[index]));
 		} else {
 			// example: if there is a declared sink at parameter 3,
@@ -201,6 +851,7 @@ void post_process_policies(Tcl_Interp *interp, policies &pol, Tcl_Obj *CONST obj
 			// in order correctly point into the 4th index of objv array
 
 			int index = *s + 1;
+			release_pointer_handle(get_pointer_handle(objv[index], 0));
 			Tcl_DeleteCommand(interp, Tcl_GetString(objv[index]));
 		}
 	}
@@ -209,39 +860,15 @@ void post_process_policies(Tcl_Interp *interp, policies &pol, Tcl_Obj *CONST obj
 // actual functions handling various callbacks
 
 // generic callback handler
-extern "C" int callback_handler(ClientData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[]) {
-	callback_map::iterator it = callbacks.find(interp);
-
-	if (it == callbacks.end()) {
-		Tcl_SetObjResult(interp, Tcl_NewStringObj("Trying to invoke non-existent callback (wrong interpreter?)", -1));
-		return TCL_ERROR;
-	}
-
-	string cmdName(Tcl_GetString(objv[0]));
-	callback_interp_map::iterator iti = it->second.find(cmdName);
-	if (iti == it->second.end()) {
-		Tcl_SetObjResult(interp, Tcl_NewStringObj("Trying to invoke non-existent callback (wrong cmd name?)", -1));
-		return TCL_ERROR;
-	}
-
-	policies_map::iterator pit = call_policies.find(interp);
-	if (pit == call_policies.end()) {
-		Tcl_SetObjResult(interp, Tcl_NewStringObj("Trying to invoke callback with no known policies", -1));
-		return TCL_ERROR;
-	}
-
-	policies_interp_map::iterator piti;
-	if (find_policies(interp, cmdName, piti) == false) {
-		Tcl_SetObjResult(interp, Tcl_NewStringObj("Trying to invoke callback with no known policies", -1));
-		return TCL_ERROR;
-	}
-
-	policies &pol = piti->second;
+extern "C" int callback_handler(ClientData cd, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[]) {
+	function_record *rec = static_cast<function_record *>(cd);
 
 	try {
-		iti->second->invoke(interp, objc, objv, pol);
+		if (rec->cb_->invoke(interp, objc, objv, rec->pol_) != TCL_OK) {
+			return TCL_ERROR;
+		}
 
-		post_process_policies(interp, pol, objv, false);
+		post_process_policies(interp, rec->pol_, objv, false);
 	} catch (exception const &e) {
 		Tcl_SetObjResult(interp, Tcl_NewStringObj(const_cast<char *>(e.what()), -1));
 		return TCL_ERROR;
@@ -255,28 +882,38 @@ extern "C" int callback_handler(ClientData, Tcl_Interp *interp, int objc, Tcl_Ob
 
 // generic "object" command handler
 extern "C" int object_handler(ClientData cd, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[]) {
-	// here, client data points to the singleton object
-	// which is responsible for managing commands for
-	// objects of a given type
+	// here, client data points to the object record, which
+	// refers to the singleton object responsible for managing
+	// commands for objects of a given type
+
+	object_record *rec = static_cast<object_record *>(cd);
+	class_handler_base *chb = rec->chb_;
+	void *p = rec->p_;
 
-	class_handler_base *chb = reinterpret_cast<class_handler_base *>(cd);
+	try {
+		if (objc < 2) {
+			throw tcl_error("Too few arguments.");
+		}
 
-	// the command name has the form 'pXXX' where XXX is the address
-	// of the "this" object
+		// dispatch on the method name
 
-	string const str(Tcl_GetString(objv[0]));
-	istringstream ss(str);
-	char dummy;
-	void *p;
-	ss >> dummy >> p;
+		method_entry const &m = chb->get_method(objv[1]);
 
-	try {
-		string methodName(Tcl_GetString(objv[1]));
-		policies &pol = chb->get_policies(methodName);
+		if (!m.cmd_) {
+			// this is the builtin -delete method
+			// - the record is released together with the command
 
-		chb->invoke(p, interp, objc, objv, pol);
+			Tcl_DeleteCommandFromToken(interp, rec->token_);
+			release_pointer_handle(p);
+			chb->destroy(p);
+			return TCL_OK;
+		}
+
+		if (m.cmd_->invoke(p, interp, objc, objv, m.pol_) != TCL_OK) {
+			return TCL_ERROR;
+		}
 
-		post_process_policies(interp, pol, objv, true);
+		post_process_policies(interp, m.pol_, objv, true);
 	} catch (exception const &e) {
 		Tcl_SetObjResult(interp, Tcl_NewStringObj(const_cast<char *>(e.what()), -1));
 		return TCL_ERROR;
@@ -290,41 +927,22 @@ extern "C" int object_handler(ClientData cd, Tcl_Interp *interp, int objc, Tcl_O
 
 // generic "constructor" command
 extern "C" int constructor_handler(ClientData cd, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[]) {
-	// here, client data points to the singleton object
-	// which is responsible for managing commands for
-	// objects of a given type
-
-	class_handler_base *chb = reinterpret_cast<class_handler_base *>(cd);
-
-	callback_map::iterator it = constructors.find(interp);
-	if (it == constructors.end()) {
-		Tcl_SetObjResult(interp, Tcl_NewStringObj("Trying to invoke non-existent callback (wrong interpreter?)", -1));
-		return TCL_ERROR;
-	}
-
-	string className(Tcl_GetString(objv[0]));
-	callback_interp_map::iterator iti = it->second.find(className);
-	if (iti == it->second.end()) {
-		Tcl_SetObjResult(interp, Tcl_NewStringObj("Trying to invoke non-existent callback (wrong class name?)", -1));
-		return TCL_ERROR;
-	}
-
-	policies_interp_map::iterator piti;
-	if (find_policies(interp, className, piti) == false) {
-		Tcl_SetObjResult(interp, Tcl_NewStringObj("Trying to invoke callback with no known policies", -1));
-		return TCL_ERROR;
-	}
+	// here, client data points to the constructor record,
+	// which refers to the singleton object responsible for
+	// managing commands for objects of a given type
 
-	policies &pol = piti->second;
+	callback_record *rec = static_cast<callback_record *>(cd);
 
 	try {
-		iti->second->invoke(interp, objc, objv, pol);
+		if (rec->cb_->invoke(interp, objc, objv, rec->pol_) != TCL_OK) {
+			return TCL_ERROR;
+		}
 
 		// if everything went OK, the result is the address of the
 		// new object in the 'pXXX' form
 		// - we can create a new command with this name
 
-		Tcl_CreateObjCommand(interp, Tcl_GetString(Tcl_GetObjResult(interp)), object_handler, static_cast<ClientData>(chb), 0);
+		create_object_command(interp, rec->chb_.get());
 	} catch (exception const &e) {
 		Tcl_SetResult(interp, const_cast<char *>(e.what()), TCL_VOLATILE);
 		return TCL_ERROR;
@@ -336,9 +954,245 @@ extern "C" int constructor_handler(ClientData cd, Tcl_Interp *interp, int objc,
 	return TCL_OK;
 }
 
-} // namespace
+// generic handler of classes in handle mode
+// - this is the only command of the class, the objects are
+//   only handle values:
+//   % set h [Name new par1 par2]
+//   % Name method $h par1 par2
+//   % Name -delete $h
+extern "C" int handle_class_handler(ClientData cd, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[]) {
+	callback_record *rec = static_cast<callback_record *>(cd);
+	class_handler_base *chb = rec->chb_.get();
 
-Tcl::details::no_init_type Tcl::no_init;
+	try {
+		if (objc < 2) {
+			throw tcl_error("Too few arguments.");
+		}
+
+		if (strcmp(Tcl_GetString(objv[1]), "new") == 0) {
+			// the constructor takes its arguments from objv[1],
+			// the result is the handle of the new object
+			if (rec->cb_->invoke(interp, objc - 1, objv + 1, rec->pol_) != TCL_OK) {
+				return TCL_ERROR;
+			}
+
+			own_pointer_handle(Tcl_GetObjResult(interp), chb->tag());
+			return TCL_OK;
+		}
+
+		if (objc < 3) {
+			throw tcl_error("Too few arguments.");
+		}
+
+		method_entry const &m = chb->get_method(objv[1]);
+		void *p = get_pointer_handle(objv[2], chb->tag(), true);
+
+		if (!m.cmd_) {
+			// this is the builtin -delete method
+			release_pointer_handle(p);
+			chb->destroy(p);
+			return TCL_OK;
+		}
+
+		// the method handlers take their arguments from objv[2]
+		if (m.cmd_->invoke(p, interp, objc - 1, objv + 1, m.pol_) != TCL_OK) {
+			return TCL_ERROR;
+		}
+
+		post_process_policies(interp, m.pol_, objv + 1, true);
+	} catch (exception const &e) {
+		Tcl_SetObjResult(interp, Tcl_NewStringObj(e.what(), -1));
+		return TCL_ERROR;
+	} catch (...) {
+		Tcl_SetObjResult(interp, Tcl_NewStringObj("Unknown error.", -1));
+		return TCL_ERROR;
+	}
+
+	return TCL_OK;
+}
+
+// state of the innermost running command defined with the nre policy
+// - the tail evaluation is only recorded while the C++ code runs,
+//   it is handed over to Tcl after the command has succeeded
+// - the chain of frames is per thread, like the interpreters
+struct nr_frame {
+	nr_frame(Tcl_Interp *interp) : interp_(interp), script_(0), then_(0), outer_(current_nr_frame) { current_nr_frame = this; }
+	~nr_frame() { current_nr_frame = outer_; }
+
+	Tcl_Interp *interp_;
+	Tcl_Obj *script_;
+	continuation_base *then_;
+	nr_frame *outer_;
+
+	static thread_local nr_frame *current_nr_frame;
+};
+
+thread_local nr_frame *nr_frame::current_nr_frame = 0;
+
+extern "C" int tail_eval_done(ClientData data[], Tcl_Interp *interp, int result);
+
+// schedules the recorded tail evaluation, if the command succeeded
+int finish_nr_frame(nr_frame &frame, int code) {
+	unique_ptr<continuation_base> then(frame.then_);
+	Tcl_Obj *script = frame.script_;
+	if (script == 0) {
+		return code;
+	}
+
+	if (code == TCL_OK) {
+		if (then) {
+			Tcl_NRAddCallback(frame.interp_, tail_eval_done, then.release(), 0, 0, 0);
+		}
+		code = Tcl_NREvalObj(frame.interp_, script, 0);
+	}
+
+	Tcl_DecrRefCount(script);
+	return code;
+}
+
+// called by Tcl when the tail evaluation is done
+extern "C" int tail_eval_done(ClientData data[], Tcl_Interp *interp, int result) {
+	unique_ptr<continuation_base> then(static_cast<continuation_base *>(data[0]));
+	if (result != TCL_OK) {
+		return result;
+	}
+
+	nr_frame frame(interp);
+	int code = TCL_OK;
+	try {
+		object res(Tcl_GetObjResult(interp), true);
+		res.set_interp(interp);
+		then->invoke(interp, res);
+	} catch (exception const &e) {
+		Tcl_SetObjResult(interp, Tcl_NewStringObj(e.what(), -1));
+		code = TCL_ERROR;
+	} catch (...) {
+		Tcl_SetObjResult(interp, Tcl_NewStringObj("Unknown error.", -1));
+		code = TCL_ERROR;
+	}
+
+	return finish_nr_frame(frame, code);
+}
+
+// free function command handler used by NR-aware callers
+extern "C" int nr_callback_handler(ClientData cd, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[]) {
+	nr_frame frame(interp);
+	int code = callback_handler(cd, interp, objc, objv);
+
+	return finish_nr_frame(frame, code);
+}
+
+// free function command handler used by all other callers
+extern "C" int nr_callback_entry(ClientData cd, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[]) { return Tcl_NRCallObjProc(interp, nr_callback_handler, cd, objc, objv); }
+
+// C++ object kept as the metadata of an instance of a TclOO class
+// - the object is deleted together with the instance
+struct oo_instance {
+	oo_instance(shared_ptr<class_handler_base> chb, void *p) : chb_(chb), p_(p) {}
+	~oo_instance() { chb_->destroy(p_); }
+
+	shared_ptr<class_handler_base> chb_;
+	void *p_;
+};
+
+extern "C" void oo_instance_delete(ClientData cd) { delete static_cast<oo_instance *>(cd); }
+
+// the class handler is owned by the TclOO class
+extern "C" void oo_class_delete(ClientData cd) { delete static_cast<shared_ptr<class_handler_base> *>(cd); }
+
+Tcl_ObjectMetadataType oo_class_metadata = {TCL_OO_METADATA_VERSION_CURRENT, "cpptcl::class", oo_class_delete, 0};
+
+// single method of a TclOO class, owned by TclOO
+struct oo_method_record {
+	oo_method_record(class_handler_base *chb, unique_ptr<object_cmd_base> cmd, policies const &pol) : chb_(chb), cmd_(std::move(cmd)), pol_(pol) {}
+
+	class_handler_base *chb_;
+	unique_ptr<object_cmd_base> cmd_;
+	policies pol_;
+};
+
+extern "C" void oo_method_delete(ClientData cd) { delete static_cast<oo_method_record *>(cd); }
+
+// the C++ methods cannot be copied together with the class
+extern "C" int oo_method_clone(Tcl_Interp *interp, ClientData, ClientData *) {
+	Tcl_SetObjResult(interp, Tcl_NewStringObj("C++ methods cannot be copied.", -1));
+	return TCL_ERROR;
+}
+
+// TclOO method handler
+extern "C" int oo_method_handler(ClientData cd, Tcl_Interp *interp, Tcl_ObjectContext context, int objc, Tcl_Obj *CONST objv[]) {
+	oo_method_record *rec = static_cast<oo_method_record *>(cd);
+
+	try {
+		oo_instance *inst = static_cast<oo_instance *>(Tcl_ObjectGetMetadata(Tcl_ObjectContextObject(context), rec->chb_->oo_metadata_type()));
+		if (inst == 0) {
+			throw tcl_error("Object has no C++ instance.");
+		}
+
+		// the method handlers take their arguments from objv[2],
+		// TclOO tells how many leading words are to be skipped
+		int skip = static_cast<int>(Tcl_ObjectContextSkippedArgs(context));
+		vector<Tcl_Obj *> shifted;
+		Tcl_Obj *CONST *args = objv + skip - 2;
+		if (skip < 2) {
+			shifted.assign(objv, objv + objc);
+			shifted.insert(shifted.begin(), 2 - skip, objv[0]);
+			args = shifted.data();
+		}
+
+		if (rec->cmd_->invoke(inst->p_, interp, objc - skip + 2, args, rec->pol_) != TCL_OK) {
+			return TCL_ERROR;
+		}
+
+		post_process_policies(interp, rec->pol_, args, true);
+	} catch (exception const &e) {
+		Tcl_SetObjResult(interp, Tcl_NewStringObj(e.what(), -1));
+		return TCL_ERROR;
+	} catch (...) {
+		Tcl_SetObjResult(interp, Tcl_NewStringObj("Unknown error.", -1));
+		return TCL_ERROR;
+	}
+
+	return TCL_OK;
+}
+
+Tcl_MethodType oo_method_type = {TCL_OO_METHOD_VERSION_CURRENT, "cpptcl::method", oo_method_handler, oo_method_delete, oo_method_clone};
+
+// TclOO constructor handler
+// - the C++ object is created and attached to the new instance
+extern "C" int oo_constructor_handler(ClientData cd, Tcl_Interp *interp, Tcl_ObjectContext context, int objc, Tcl_Obj *CONST objv[]) {
+	callback_record *rec = static_cast<callback_record *>(cd);
+
+	try {
+		// the constructor callback takes its arguments from objv[1]
+		int skip = static_cast<int>(Tcl_ObjectContextSkippedArgs(context));
+		if (rec->cb_->invoke(interp, objc - skip + 1, objv + skip - 1, rec->pol_) != TCL_OK) {
+			return TCL_ERROR;
+		}
+
+		// the result is the handle of the new object,
+		// which is not needed for TclOO instances
+		void *p = get_pointer_handle(Tcl_GetObjResult(interp), 0);
+		release_pointer_handle(p);
+		Tcl_ResetResult(interp);
+
+		Tcl_ObjectSetMetadata(Tcl_ObjectContextObject(context), rec->chb_->oo_metadata_type(), new oo_instance(rec->chb_, p));
+	} catch (exception const &e) {
+		Tcl_SetObjResult(interp, Tcl_NewStringObj(e.what(), -1));
+		return TCL_ERROR;
+	} catch (...) {
+		Tcl_SetObjResult(interp, Tcl_NewStringObj("Unknown error.", -1));
+		return TCL_ERROR;
+	}
+
+	return TCL_OK;
+}
+
+Tcl_MethodType oo_constructor_type = {TCL_OO_METHOD_VERSION_CURRENT, "cpptcl::constructor", oo_constructor_handler, callback_record_delete, oo_method_clone};
+
+} // namespace
+
+Tcl::details::no_init_type Tcl::no_init;
 
 policies &policies::factory(string const &name) {
 	factory_ = name;
@@ -355,6 +1209,11 @@ policies &policies::variadic() {
 	return *this;
 }
 
+policies &policies::nre() {
+	nre_ = true;
+	return *this;
+}
+
 policies &policies::usage(string const &message) {
 	usage_ = std::string("Usage: ") + message;
 	return *this;
@@ -366,25 +1225,259 @@ policies Tcl::sink(int index) { return policies().sink(index); }
 
 policies Tcl::variadic() { return policies().variadic(); }
 
+policies Tcl::nre() { return policies().nre(); }
+
 policies Tcl::usage(string const &message) { return policies().usage(message); }
 
-class_handler_base::class_handler_base() {
+namespace // anonymous
+{
+
+// source of the unique epochs of class handlers
+// (classes can be defined in interpreters of different threads)
+atomic<unsigned long> method_epoch(0);
+
+extern "C" void update_method_string_proc(Tcl_Obj *obj) {
+	method_entry const *m = static_cast<method_entry const *>(obj->internalRep.twoPtrValue.ptr1);
+
+	obj->bytes = Tcl_Alloc(static_cast<unsigned>(m->name_.size()) + 1);
+	memcpy(obj->bytes, m->name_.c_str(), m->name_.size() + 1);
+	obj->length = static_cast<int>(m->name_.size());
+}
+
+// method names cache the resolved method entry and the epoch
+// of the class handler, which tells if the entry is still valid
+Tcl_ObjType method_type = {
+	const_cast<char *>("cpptcl::method"), // name
+	0,									 // freeIntRepProc
+	dup_intrep_proc,					 // dupIntRepProc
+	update_method_string_proc,			 // updateStringProc
+	0									 // setFromAnyProc
+};
+
+// FNV-1a hash of the method name
+uint32_t method_hash(char const *s, size_t len) {
+	uint32_t h = 2166136261u;
+	for (size_t i = 0; i != len; ++i) {
+		h = (h ^ static_cast<unsigned char>(s[i])) * 16777619u;
+	}
+	return h;
+}
+
+} // namespace
+
+method_entry::method_entry(string const &name, unique_ptr<object_cmd_base> cmd, policies const &pol) : name_(name), cmd_(std::move(cmd)), pol_(pol) {}
+
+class_handler_base::class_handler_base() : sealed_(false), epoch_(++method_epoch), tag_(0), handle_mode_(false), oo_interp_(0), oo_class_(0) {
 	// default policies for the -delete command
-	policies_["-delete"] = policies();
+	methods_.push_back(method_entry("-delete", unique_ptr<object_cmd_base>(), policies()));
+
+	// each class has its own metadata type, so that the instances
+	// of Tcl classes can inherit from more than one C++ class
+	oo_metadata_.version = TCL_OO_METADATA_VERSION_CURRENT;
+	oo_metadata_.name = "cpptcl::instance";
+	oo_metadata_.deleteProc = oo_instance_delete;
+	oo_metadata_.cloneProc = 0;
+}
+
+void class_handler_base::set_oo_class(Tcl_Interp *interp, Tcl_Class cls) {
+	oo_interp_ = interp;
+	oo_class_ = cls;
+}
+
+void class_handler_base::register_method(string const &name, unique_ptr<object_cmd_base> ocb, policies const &p) {
+	if (oo_class_ != 0) {
+		// TclOO replaces the method of the same name, if any
+		Tcl_NewMethod(oo_interp_, oo_class_, Tcl_NewStringObj(name.data(), static_cast<int>(name.size())), 1, &oo_method_type, new oo_method_record(this, std::move(ocb), p));
+		return;
+	}
+
+	// the table can be reallocated, so the new epoch
+	// invalidates all the entries cached so far
+	sealed_ = false;
+	epoch_ = ++method_epoch;
+
+	for (vector<method_entry>::iterator it = methods_.begin(); it != methods_.end(); ++it) {
+		if (it->name_ == name) {
+			it->cmd_ = std::move(ocb);
+			it->pol_ = p;
+			return;
+		}
+	}
+
+	methods_.push_back(method_entry(name, std::move(ocb), p));
+}
+
+void class_handler_base::seal() {
+	size_t size = 4;
+	while (size < 2 * methods_.size()) {
+		size *= 2;
+	}
+
+	method_slot empty = {0, 0};
+	slots_.assign(size, empty);
+
+	size_t mask = size - 1;
+	for (size_t i = 0; i != methods_.size(); ++i) {
+		uint32_t h = method_hash(methods_[i].name_.data(), methods_[i].name_.size());
+		size_t pos = h & mask;
+		while (slots_[pos].index_ != 0) {
+			pos = (pos + 1) & mask;
+		}
+		slots_[pos].hash_ = h;
+		slots_[pos].index_ = static_cast<uint32_t>(i + 1);
+	}
+
+	methods_.shrink_to_fit();
+	sealed_ = true;
+}
+
+method_entry const &class_handler_base::get_method(Tcl_Obj *name) {
+	void *epoch = reinterpret_cast<void *>(static_cast<uintptr_t>(epoch_));
+	if (name->typePtr == &method_type && name->internalRep.twoPtrValue.ptr2 == epoch) {
+		return *static_cast<method_entry const *>(name->internalRep.twoPtrValue.ptr1);
+	}
+
+	if (!sealed_) {
+		seal();
+	}
+
+	Tcl_Size len;
+	char const *s = Tcl_GetStringFromObj(name, &len);
+	uint32_t h = method_hash(s, len);
+
+	size_t mask = slots_.size() - 1;
+	method_entry const *m = 0;
+	for (size_t pos = h & mask; slots_[pos].index_ != 0; pos = (pos + 1) & mask) {
+		if (slots_[pos].hash_ == h) {
+			method_entry const &candidate = methods_[slots_[pos].index_ - 1];
+			if (candidate.name_.size() == static_cast<size_t>(len) && memcmp(candidate.name_.data(), s, len) == 0) {
+				m = &candidate;
+				break;
+			}
+		}
+	}
+
+	if (m == 0) {
+		throw tcl_error("Method " + string(s, s + len) + " not found.");
+	}
+
+	if (name->typePtr != 0 && name->typePtr->freeIntRepProc != 0) {
+		name->typePtr->freeIntRepProc(name);
+	}
+
+	name->internalRep.twoPtrValue.ptr1 = const_cast<method_entry *>(m);
+	name->internalRep.twoPtrValue.ptr2 = epoch;
+	name->typePtr = &method_type;
+
+	return *m;
+}
+
+byte_span::byte_span(size_t size) : obj_(Tcl_NewByteArrayObj(0, 0)), size_(size) {
+	Tcl_IncrRefCount(obj_);
+	data_ = Tcl_SetByteArrayLength(obj_, static_cast<int>(size));
+}
+
+byte_span::byte_span(byte_span const &other) : obj_(other.obj_), data_(other.data_), size_(other.size_) {
+	if (obj_ != 0) {
+		Tcl_IncrRefCount(obj_);
+	}
+}
+
+byte_span::byte_span(byte_span &&other) noexcept : obj_(other.obj_), data_(other.data_), size_(other.size_) {
+	other.obj_ = 0;
+	other.data_ = 0;
+	other.size_ = 0;
+}
+
+byte_span::~byte_span() {
+	if (obj_ != 0) {
+		Tcl_DecrRefCount(obj_);
+	}
+}
+
+byte_span &byte_span::operator=(byte_span other) noexcept {
+	std::swap(obj_, other.obj_);
+	std::swap(data_, other.data_);
+	std::swap(size_, other.size_);
+	return *this;
 }
 
-void class_handler_base::register_method(string const &name, shared_ptr<object_cmd_base> ocb, policies const &p) {
-	methods_[name] = ocb;
-	policies_[name] = p;
+void byte_span::resize(size_t size) {
+	// the copies of the span keep the old bytes
+	if (obj_ == 0 || Tcl_IsShared(obj_)) {
+		Tcl_Obj *obj = obj_ != 0 ? Tcl_DuplicateObj(obj_) : Tcl_NewByteArrayObj(0, 0);
+		Tcl_IncrRefCount(obj);
+		if (obj_ != 0) {
+			Tcl_DecrRefCount(obj_);
+		}
+		obj_ = obj;
+	}
+
+	data_ = Tcl_SetByteArrayLength(obj_, static_cast<int>(size));
+	size_ = size;
+}
+
+result_writer::result_writer() : obj_(Tcl_NewObj()), capacity_(0) { Tcl_IncrRefCount(obj_); }
+
+result_writer::result_writer(result_writer &&other) noexcept : obj_(other.obj_), capacity_(other.capacity_) {
+	other.obj_ = 0;
+	other.capacity_ = 0;
+}
+
+result_writer::~result_writer() {
+	if (obj_ != 0) {
+		Tcl_DecrRefCount(obj_);
+	}
+}
+
+// Tcl_SetObjLength keeps the buffer when the string is shortened,
+// so growing and shortening it again leaves the room in place
+void result_writer::reserve(size_t size) {
+	if (size <= capacity_) {
+		return;
+	}
+
+	Tcl_Size length = obj_->length;
+	Tcl_SetObjLength(obj_, static_cast<int>(size));
+	Tcl_SetObjLength(obj_, length);
+	capacity_ = size;
 }
 
-policies &class_handler_base::get_policies(string const &name) {
-	policies_map_type::iterator it = policies_.find(name);
-	if (it == policies_.end()) {
-		throw tcl_error("Trying to use non-existent policy: " + name);
+char *result_writer::extend(size_t n) {
+	size_t length = obj_->length;
+	if (length + n > capacity_) {
+		reserve(std::max(length + n, 2 * capacity_));
 	}
 
-	return it->second;
+	Tcl_SetObjLength(obj_, static_cast<int>(length + n));
+	return obj_->bytes + length;
+}
+
+void result_writer::resize(size_t size) {
+	reserve(size);
+	Tcl_SetObjLength(obj_, static_cast<int>(size));
+}
+
+result_writer &result_writer::append(char const *s, size_t n) {
+	memcpy(extend(n), s, n);
+	return *this;
+}
+
+result_writer &result_writer::operator<<(double d) {
+	char buf[TCL_DOUBLE_SPACE];
+	return append(buf, format_double(d, buf));
+}
+
+result_writer &result_writer::append_integer(long long i) {
+	char buf[24];
+	char *end = to_chars(buf, buf + sizeof(buf), i).ptr;
+	return append(buf, end - buf);
+}
+
+result_writer &result_writer::append_unsigned(unsigned long long i) {
+	char buf[24];
+	char *end = to_chars(buf, buf + sizeof(buf), i).ptr;
+	return append(buf, end - buf);
 }
 
 object::object() : interp_(0) {
@@ -642,6 +1735,32 @@ Tcl_Interp *object::get_interp() const { return interp_; }
 
 Tcl::interpreter *interpreter::defaultInterpreter = nullptr;
 
+namespace // anonymous
+{
+
+// sets up the TclOO stubs table, if not done yet
+// - without the Tcl stubs, Tcl_OOInitStubs does nothing, and the
+//   table is taken from the package instead
+void init_oo_stubs(Tcl_Interp *interp) {
+	if (tclOOStubsPtr != 0) {
+		return;
+	}
+
+#ifdef CPPTCL_NO_TCL_STUBS
+	ClientData stubs = 0;
+	if (Tcl_PkgRequireEx(interp, "TclOO", TCLOO_VERSION, 0, &stubs) == NULL || stubs == 0) {
+		throw tcl_error("Failed to initialize TclOO stubs");
+	}
+	tclOOStubsPtr = static_cast<TclOOStubs const *>(stubs);
+#else
+	if (Tcl_OOInitStubs(interp) == NULL) {
+		throw tcl_error("Failed to initialize TclOO stubs");
+	}
+#endif
+}
+
+} // namespace
+
 interpreter::interpreter() {
 	interp_ = Tcl_CreateInterp();
 	owner_ = true;
@@ -657,6 +1776,7 @@ interpreter::interpreter(Tcl_Interp *interp, bool owner) {
 		if (Tcl_InitStubs(interp, "8.6", 0) == NULL) {
 			throw tcl_error("Failed to initialize stubs");
 		}
+		init_oo_stubs(interp);
 		// Make a copy
 		defaultInterpreter = new interpreter(*this);
 	}
@@ -766,44 +1886,34 @@ void interpreter::create_alias(string const &cmd, interpreter &targetInterp, str
 
 void interpreter::clear_definitions(Tcl_Interp *interp) {
 	// delete all callbacks that were registered for given interpreter
+	// (the callback records are released together with the commands)
 
 	{
-		callback_map::iterator it = callbacks.find(interp);
-
-		if (it == callbacks.end()) {
-			// no callbacks defined for this interpreter
-			return;
-		}
-
-		callback_interp_map &imap = it->second;
-		for (callback_interp_map::iterator it2 = imap.begin(); it2 != imap.end(); ++it2) {
-			Tcl_DeleteCommand(interp, it2->first.c_str());
+		command_names_map::iterator it = callbacks.find(interp);
+		if (it != callbacks.end()) {
+			command_names &names = it->second;
+			for (command_names::iterator it2 = names.begin(); it2 != names.end(); ++it2) {
+				Tcl_DeleteCommand(interp, it2->c_str());
+			}
+
+			callbacks.erase(it);
 		}
-
-		callbacks.erase(interp);
 	}
 
 	// delete all constructors
 
 	{
-		callback_map::iterator it = constructors.find(interp);
-		if (it == constructors.end()) {
-			// no callbacks defined for this interpreter
-			return;
-		}
-
-		callback_interp_map &imap = it->second;
-		for (callback_interp_map::iterator it2 = imap.begin(); it2 != imap.end(); ++it2) {
-			Tcl_DeleteCommand(interp, it2->first.c_str());
+		command_names_map::iterator it = constructors.find(interp);
+		if (it != constructors.end()) {
+			command_names &names = it->second;
+			for (command_names::iterator it2 = names.begin(); it2 != names.end(); ++it2) {
+				Tcl_DeleteCommand(interp, it2->c_str());
+			}
+
+			constructors.erase(it);
 		}
-
-		callbacks.erase(interp);
 	}
 
-	// delete all call policies
-
-	call_policies.erase(interp);
-
 	// delete all object handlers
 	// (we have to assume that all living objects were destroyed,
 	// otherwise Bad Things will happen)
@@ -811,65 +1921,345 @@ void interpreter::clear_definitions(Tcl_Interp *interp) {
 	class_handlers.erase(interp);
 }
 
-void interpreter::add_function(string const &name, shared_ptr<callback_base> cb, policies const &p) {
-	Tcl_CreateObjCommand(interp_, name.c_str(), callback_handler, 0, 0);
+void interpreter::add_function(string const &name, unique_ptr<function_record> rec) {
+	if (rec->pol_.nre_) {
+		Tcl_NRCreateCommand(interp_, name.c_str(), nr_callback_entry, nr_callback_handler, static_cast<ClientData>(rec.release()), function_record_delete);
+	} else {
+		Tcl_CreateObjCommand(interp_, name.c_str(), callback_handler, static_cast<ClientData>(rec.release()), function_record_delete);
+	}
+
+	callbacks[interp_].insert(name);
+}
+
+void interpreter::add_handle_class(string const &name, shared_ptr<class_handler_base> chb, shared_ptr<callback_base> cb, policies const &p) {
+	chb->set_handle_mode();
+	class_handlers[interp_][name] = chb;
+
+	callback_record *rec = new callback_record(cb, p, chb);
+	Tcl_CreateObjCommand(interp_, name.c_str(), handle_class_handler, static_cast<ClientData>(rec), callback_record_delete);
+
+	constructors[interp_].insert(name);
+}
+
+void interpreter::add_oo_class(string const &name, shared_ptr<class_handler_base> chb, shared_ptr<callback_base> cb, policies const &p) {
+	init_oo_stubs(interp_);
+
+	object meta("::oo::class");
+	Tcl_Object metaObj = Tcl_GetObjectFromObj(interp_, meta.get_object());
+	if (metaObj == 0) {
+		throw tcl_error(interp_);
+	}
+
+	Tcl_Object classObj = Tcl_NewObjectInstance(interp_, Tcl_GetObjectAsClass(metaObj), name.c_str(), 0, -1, 0, 0);
+	if (classObj == 0) {
+		throw tcl_error(interp_);
+	}
+
+	Tcl_Class cls = Tcl_GetObjectAsClass(classObj);
+	Tcl_ClassSetMetadata(cls, &oo_class_metadata, new shared_ptr<class_handler_base>(chb));
+	chb->set_oo_class(interp_, cls);
+
+	callback_record *rec = new callback_record(cb, p, chb);
+	Tcl_ClassSetConstructor(interp_, cls, Tcl_NewMethod(interp_, cls, 0, 1, &oo_constructor_type, rec));
+
+	constructors[interp_].insert(name);
+}
+
+void interpreter::schedule_tail_eval(object const &script, unique_ptr<continuation_base> then) {
+	nr_frame *frame = nr_frame::current_nr_frame;
+	if (frame == 0 || frame->interp_ != interp_) {
+		throw tcl_error("Tail evaluation is possible only in commands defined with the nre policy.");
+	}
+	if (frame->script_ != 0) {
+		throw tcl_error("Tail evaluation was already scheduled.");
+	}
+
+	frame->script_ = script.get_object();
+	Tcl_IncrRefCount(frame->script_);
+	frame->then_ = then.release();
+}
+
+void interpreter::add_command(string const &name, Tcl_ObjCmdProc *proc) {
+	Tcl_CreateObjCommand(interp_, name.c_str(), proc, 0, 0);
 
-	callbacks[interp_][name] = cb;
-	call_policies[interp_][name] = p;
+	callbacks[interp_].insert(name);
 }
 
 void interpreter::add_class(string const &name, shared_ptr<class_handler_base> chb) { class_handlers[interp_][name] = chb; }
 
 void interpreter::add_constructor(string const &name, shared_ptr<class_handler_base> chb, shared_ptr<callback_base> cb, policies const &p) {
-	Tcl_CreateObjCommand(interp_, name.c_str(), constructor_handler, static_cast<ClientData>(chb.get()), 0);
+	callback_record *rec = new callback_record(cb, p, chb);
+	Tcl_CreateObjCommand(interp_, name.c_str(), constructor_handler, static_cast<ClientData>(rec), callback_record_delete);
 
-	constructors[interp_][name] = cb;
-	call_policies[interp_][name] = p;
+	constructors[interp_].insert(name);
 }
 
 int tcl_cast<int>::from(Tcl_Interp *interp, Tcl_Obj *obj, bool) {
 	int res;
-	int cc = Tcl_GetIntFromObj(interp, obj, &res);
-	if (cc != TCL_OK) {
+	if (convert(interp, obj, res) != TCL_OK) {
 		throw tcl_error(interp);
 	}
 
 	return res;
 }
 
+int tcl_cast<int>::convert(Tcl_Interp *interp, Tcl_Obj *obj, int &res) noexcept {
+	// Tcl_GetIntFromObj would accept the values up to UINT_MAX wrapped around
+	Tcl_WideInt w;
+	if (get_wide_int(interp, obj, w) != TCL_OK) {
+		return TCL_ERROR;
+	}
+	if (w < numeric_limits<int>::min() || w > numeric_limits<int>::max()) {
+		return integer_range_error(interp);
+	}
+
+	res = static_cast<int>(w);
+	return TCL_OK;
+}
+
 long tcl_cast<long>::from(Tcl_Interp *interp, Tcl_Obj *obj, bool) {
 	long res;
-	int cc = Tcl_GetLongFromObj(interp, obj, &res);
-	if (cc != TCL_OK) {
+	if (convert(interp, obj, res) != TCL_OK) {
 		throw tcl_error(interp);
 	}
 
 	return res;
 }
 
+int tcl_cast<long>::convert(Tcl_Interp *interp, Tcl_Obj *obj, long &res) noexcept {
+	Tcl_WideInt w;
+	if (get_wide_int(interp, obj, w) != TCL_OK) {
+		return TCL_ERROR;
+	}
+	if (w < numeric_limits<long>::min() || w > numeric_limits<long>::max()) {
+		return integer_range_error(interp);
+	}
+
+	res = static_cast<long>(w);
+	return TCL_OK;
+}
+
 bool tcl_cast<bool>::from(Tcl_Interp *interp, Tcl_Obj *obj, bool) {
-	int res;
-	int cc = Tcl_GetBooleanFromObj(interp, obj, &res);
-	if (cc != TCL_OK) {
+	bool res;
+	if (convert(interp, obj, res) != TCL_OK) {
 		throw tcl_error(interp);
 	}
 
-	return res != 0;
+	return res;
+}
+
+int tcl_cast<bool>::convert(Tcl_Interp *interp, Tcl_Obj *obj, bool &res) noexcept {
+	int b;
+	int cc = Tcl_GetBooleanFromObj(interp, obj, &b);
+	res = b != 0;
+	return cc;
 }
 
 double tcl_cast<double>::from(Tcl_Interp *interp, Tcl_Obj *obj, bool) {
 	double res;
-	int cc = Tcl_GetDoubleFromObj(interp, obj, &res);
-	if (cc != TCL_OK) {
+	if (convert(interp, obj, res) != TCL_OK) {
 		throw tcl_error(interp);
 	}
 
 	return res;
 }
 
-string tcl_cast<string>::from(Tcl_Interp *, Tcl_Obj *obj, bool) { return Tcl_GetString(obj); }
-
-char const *tcl_cast<char const *>::from(Tcl_Interp *, Tcl_Obj *obj, bool) { return Tcl_GetString(obj); }
+int tcl_cast<double>::convert(Tcl_Interp *interp, Tcl_Obj *obj, double &res) noexcept { return Tcl_GetDoubleFromObj(interp, obj, &res); }
+
+float tcl_cast<float>::from(Tcl_Interp *interp, Tcl_Obj *obj, bool) {
+	float res;
+	if (convert(interp, obj, res) != TCL_OK) {
+		throw tcl_error(interp);
+	}
+
+	return res;
+}
+
+int tcl_cast<float>::convert(Tcl_Interp *interp, Tcl_Obj *obj, float &res) noexcept {
+	double d;
+	if (Tcl_GetDoubleFromObj(interp, obj, &d) != TCL_OK) {
+		return TCL_ERROR;
+	}
+	if ((d > FLT_MAX || d < -FLT_MAX) && d != HUGE_VAL && d != -HUGE_VAL) {
+		if (interp != 0) {
+			Tcl_SetObjResult(interp, Tcl_NewStringObj("floating-point value too large to represent", -1));
+		}
+		return TCL_ERROR;
+	}
+
+	res = static_cast<float>(d);
+	return TCL_OK;
+}
+
+#if TCL_MAJOR_VERSION < 9
+namespace {
+
+// the bignum type is not registered with Tcl_GetObjType,
+// so it is taken from a value that Tcl 8 keeps as a bignum
+Tcl_ObjType const *find_bignum_type() {
+	Tcl_Obj *probe = Tcl_NewStringObj("18446744073709551615", -1);
+	Tcl_IncrRefCount(probe);
+	Tcl_WideInt w;
+	Tcl_ObjType const *type = 0;
+	if (Tcl_GetWideIntFromObj(0, probe, &w) == TCL_OK) {
+		type = probe->typePtr;
+	}
+	Tcl_DecrRefCount(probe);
+
+	return type;
+}
+
+} // namespace
+#endif
+
+int details::get_wide_int(Tcl_Interp *interp, Tcl_Obj *obj, Tcl_WideInt &res) noexcept {
+	if (Tcl_GetWideIntFromObj(interp, obj, &res) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+#if TCL_MAJOR_VERSION < 9
+	// Tcl 8 gives the values up to the range of Tcl_WideUInt
+	// wrapped around; only such values are kept as bignums
+	static Tcl_ObjType const *const bignum_type = find_bignum_type();
+	if (obj->typePtr != 0 && obj->typePtr == bignum_type) {
+		return integer_range_error(interp);
+	}
+#endif
+
+	return TCL_OK;
+}
+
+int details::get_unsigned_wide_int(Tcl_Interp *interp, Tcl_Obj *obj, Tcl_WideUInt &res) noexcept {
+#if TCL_MAJOR_VERSION >= 9
+	return Tcl_GetWideUIntFromObj(interp, obj, &res);
+#else
+	Tcl_WideInt w;
+	if (Tcl_GetWideIntFromObj(interp, obj, &w) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	// Tcl 8 gives the values above the range of Tcl_WideInt
+	// wrapped around, so the sign is taken from the string
+	if (w != 0) {
+		char const *s = Tcl_GetString(obj);
+		while (isspace(static_cast<unsigned char>(*s))) {
+			++s;
+		}
+		if (*s == '-') {
+			if (interp != 0) {
+				Tcl_SetObjResult(interp, Tcl_ObjPrintf("expected unsigned integer but got \"%s\"", Tcl_GetString(obj)));
+			}
+			return TCL_ERROR;
+		}
+	}
+
+	res = static_cast<Tcl_WideUInt>(w);
+	return TCL_OK;
+#endif
+}
+
+int details::integer_range_error(Tcl_Interp *interp) noexcept {
+	if (interp != 0) {
+		Tcl_SetObjResult(interp, Tcl_NewStringObj("integer value too large to represent", -1));
+	}
+	return TCL_ERROR;
+}
+
+string tcl_cast<string>::from(Tcl_Interp *, Tcl_Obj *obj, bool) {
+	Tcl_Size len;
+	char const *s = Tcl_GetStringFromObj(obj, &len);
+	return string(s, len);
+}
+
+int tcl_cast<string>::convert(Tcl_Interp *, Tcl_Obj *obj, string &res) {
+	Tcl_Size len;
+	char const *s = Tcl_GetStringFromObj(obj, &len);
+	res.assign(s, len);
+	return TCL_OK;
+}
+
+string_view tcl_cast<string_view>::from(Tcl_Interp *, Tcl_Obj *obj, bool) {
+	Tcl_Size len;
+	char const *s = Tcl_GetStringFromObj(obj, &len);
+	return string_view(s, len);
+}
+
+int tcl_cast<string_view>::convert(Tcl_Interp *, Tcl_Obj *obj, string_view &res) noexcept {
+	Tcl_Size len;
+	char const *s = Tcl_GetStringFromObj(obj, &len);
+	res = string_view(s, len);
+	return TCL_OK;
+}
+
+char const *tcl_cast<char const *>::from(Tcl_Interp *, Tcl_Obj *obj, bool) { return Tcl_GetString(obj); }
+
+int tcl_cast<char const *>::convert(Tcl_Interp *, Tcl_Obj *obj, char const *&res) noexcept {
+	res = Tcl_GetString(obj);
+	return TCL_OK;
+}
+
+namespace {
+
+// Tcl 9 rejects strings that are not byte sequences
+unsigned char *get_byte_array(Tcl_Interp *interp, Tcl_Obj *obj, Tcl_Size &len) noexcept {
+#if TCL_MAJOR_VERSION >= 9
+	return Tcl_GetBytesFromObj(interp, obj, &len);
+#else
+	(void)interp;
+	return Tcl_GetByteArrayFromObj(obj, &len);
+#endif
+}
+
+} // namespace
+
+const_byte_span tcl_cast<const_byte_span>::from(Tcl_Interp *interp, Tcl_Obj *obj, bool) {
+	const_byte_span res;
+	if (convert(interp, obj, res) != TCL_OK) {
+		throw tcl_error(interp);
+	}
+
+	return res;
+}
+
+int tcl_cast<const_byte_span>::convert(Tcl_Interp *interp, Tcl_Obj *obj, const_byte_span &res) noexcept {
+	Tcl_Size len;
+	unsigned char const *p = get_byte_array(interp, obj, len);
+	if (p == 0) {
+		return TCL_ERROR;
+	}
+
+	res = const_byte_span(p, len);
+	return TCL_OK;
+}
+
+byte_span tcl_cast<byte_span>::from(Tcl_Interp *interp, Tcl_Obj *obj, bool) {
+	byte_span res;
+	if (convert(interp, obj, res) != TCL_OK) {
+		throw tcl_error(interp);
+	}
+
+	return res;
+}
+
+int tcl_cast<byte_span>::convert(Tcl_Interp *interp, Tcl_Obj *obj, byte_span &res) noexcept {
+	if (Tcl_IsShared(obj)) {
+		obj = Tcl_DuplicateObj(obj);
+	}
+	Tcl_IncrRefCount(obj);
+
+	Tcl_Size len;
+	unsigned char *p = get_byte_array(interp, obj, len);
+	if (p == 0) {
+		Tcl_DecrRefCount(obj);
+		return TCL_ERROR;
+	}
+
+	// the bytes are written directly, so the string is stale
+	Tcl_InvalidateStringRep(obj);
+
+	res = byte_span(obj, p, len);
+	return TCL_OK;
+}
 
 object tcl_cast<object>::from(Tcl_Interp *interp, Tcl_Obj *obj, bool) {
 	object o(obj);
@@ -877,3 +2267,462 @@ object tcl_cast<object>::from(Tcl_Interp *interp, Tcl_Obj *obj, bool) {
 
 	return o;
 }
+
+int tcl_cast<object>::convert(Tcl_Interp *interp, Tcl_Obj *obj, object &res) noexcept {
+	res.assign(obj);
+	res.set_interp(interp);
+	return TCL_OK;
+}
+
+// lists of numbers parsed from their strings
+
+namespace {
+
+bool is_list_space(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f'; }
+
+// Tcl 8 reads 017 as an octal number
+bool leading_zero(char const *p, char const *end) {
+	if (*p == '-') {
+		++p;
+	}
+	return end - p > 1 && p[0] == '0' && isdigit(static_cast<unsigned char>(p[1]));
+}
+
+template <typename T> char const *parse_number(char const *p, char const *end, T &v) {
+	if constexpr (std::is_floating_point<T>::value) {
+#if defined(__cpp_lib_to_chars)
+		from_chars_result r = from_chars(p, end, v);
+		return r.ec == errc() && isfinite(v) ? r.ptr : 0;
+#else
+		// the floating-point from_chars is not available
+		return 0;
+#endif
+	} else {
+		from_chars_result r = from_chars(p, end, v);
+		return r.ec == errc() ? r.ptr : 0;
+	}
+}
+
+} // namespace
+
+template <typename T> bool details::parse_number_list(Tcl_Obj *obj, vector<T> &res) {
+	// only plain strings, the other objects are converted by Tcl
+	static Tcl_ObjType const *string_type = Tcl_GetObjType("string");
+	if (obj->bytes == 0 || (obj->typePtr != 0 && obj->typePtr != string_type)) {
+		return false;
+	}
+
+	char const *p = obj->bytes;
+	char const *end = p + obj->length;
+	res.clear();
+	for (;;) {
+		while (p != end && is_list_space(*p)) {
+			++p;
+		}
+		if (p == end) {
+			return true;
+		}
+
+		T v;
+		if (leading_zero(p, end) || (p = parse_number(p, end, v)) == 0 || (p != end && !is_list_space(*p))) {
+			return false;
+		}
+		res.push_back(v);
+	}
+}
+
+template bool details::parse_number_list(Tcl_Obj *, vector<double> &);
+template bool details::parse_number_list(Tcl_Obj *, vector<int> &);
+template bool details::parse_number_list(Tcl_Obj *, vector<long> &);
+template bool details::parse_number_list(Tcl_Obj *, vector<long long> &);
+
+// packed arrays
+
+namespace {
+
+template <typename T> struct packed_names;
+
+template <> struct packed_names<double> {
+	static constexpr char const *type = "cpptcl::packed_double";
+	static constexpr char const *command = "double";
+};
+
+template <> struct packed_names<float> {
+	static constexpr char const *type = "cpptcl::packed_float";
+	static constexpr char const *command = "float";
+};
+
+template <> struct packed_names<int32_t> {
+	static constexpr char const *type = "cpptcl::packed_int32";
+	static constexpr char const *command = "int32";
+};
+
+template <> struct packed_names<int64_t> {
+	static constexpr char const *type = "cpptcl::packed_int64";
+	static constexpr char const *command = "int64";
+};
+
+// formats the number as Tcl does, returns the length
+template <typename T> int format_number(T v, char *buf) {
+	if constexpr (std::is_floating_point<T>::value) {
+		return format_double(v, buf);
+	} else {
+		return static_cast<int>(to_chars(buf, buf + TCL_DOUBLE_SPACE, v).ptr - buf);
+	}
+}
+
+// type-erased operations of the packed array types, for the commands
+struct packed_ops {
+	char const *command;
+	Tcl_ObjType const *type;
+	int (*set_from_any)(Tcl_Interp *, Tcl_Obj *);
+	Tcl_Size (*length)(Tcl_Obj *);
+	Tcl_Obj *(*index)(Tcl_Obj *, Tcl_Size);
+	Tcl_Obj *(*slice)(Tcl_Obj *, Tcl_Size, Tcl_Size);
+};
+
+template <typename T> struct packed_type {
+	static packed_buffer<T> *get(Tcl_Obj *obj) { return static_cast<packed_buffer<T> *>(obj->internalRep.twoPtrValue.ptr1); }
+
+	// the object must not have an internal rep
+	static void set(Tcl_Obj *obj, packed_buffer<T> *b) {
+		++b->refs_;
+		obj->internalRep.twoPtrValue.ptr1 = b;
+		obj->typePtr = &type;
+	}
+
+	static void release(packed_buffer<T> *b) {
+		if (--b->refs_ == 0) {
+			delete b;
+		}
+	}
+
+	static packed_buffer<T> *new_buffer(vector<T> values) {
+		packed_buffer<T> *b = new packed_buffer<T>();
+		b->refs_ = 0;
+		b->values_.swap(values);
+		return b;
+	}
+
+	// new object with the given numbers and no string rep yet
+	static Tcl_Obj *new_obj(packed_buffer<T> *b) {
+		Tcl_Obj *obj = Tcl_NewObj();
+		Tcl_InvalidateStringRep(obj);
+		set(obj, b);
+		return obj;
+	}
+
+	static void free_intrep_proc(Tcl_Obj *obj) { release(get(obj)); }
+
+	// the copies share the buffer until one of them is written
+	static void dup_intrep_proc(Tcl_Obj *src, Tcl_Obj *dup) { set(dup, get(src)); }
+
+	static void update_string_proc(Tcl_Obj *obj) {
+		vector<T> const &values = get(obj)->values_;
+		size_t n = values.size();
+		if (n > static_cast<size_t>(TCL_SIZE_MAX) / TCL_DOUBLE_SPACE) {
+			Tcl_Panic("max size for a Tcl value exceeded");
+		}
+
+		// the numbers are formatted straight into the string rep,
+		// which is then shrunk to its length
+		char *buf = Tcl_Alloc(n * TCL_DOUBLE_SPACE + 1);
+		char *dst = buf;
+		for (size_t i = 0; i != n; ++i) {
+			if (i != 0) {
+				*dst++ = ' ';
+			}
+			dst += format_number(values[i], dst);
+		}
+		*dst = '\0';
+
+		obj->length = static_cast<Tcl_Size>(dst - buf);
+		obj->bytes = Tcl_Realloc(buf, obj->length + 1);
+	}
+
+	// the numbers are read from the list
+	static int set_from_any_proc(Tcl_Interp *interp, Tcl_Obj *obj) {
+		vector<T> values;
+		if constexpr (is_bulk_number<T>::value) {
+			if (parse_number_list(obj, values)) {
+				return set_values(obj, std::move(values));
+			}
+		}
+
+		Tcl_Size n;
+		Tcl_Obj **elems;
+		if (Tcl_ListObjGetElements(interp, obj, &n, &elems) != TCL_OK) {
+			return TCL_ERROR;
+		}
+
+		values.resize(n);
+		for (Tcl_Size i = 0; i != n; ++i) {
+			if (tcl_cast<T>::convert(interp, elems[i], values[i]) != TCL_OK) {
+				return TCL_ERROR;
+			}
+		}
+
+		return set_values(obj, std::move(values));
+	}
+
+	static int set_values(Tcl_Obj *obj, vector<T> values) {
+		// the string is all that remains of the old internal rep
+		Tcl_GetString(obj);
+		if (obj->typePtr != 0 && obj->typePtr->freeIntRepProc != 0) {
+			obj->typePtr->freeIntRepProc(obj);
+		}
+		set(obj, new_buffer(std::move(values)));
+
+		return TCL_OK;
+	}
+
+	static Tcl_Size length(Tcl_Obj *obj) { return static_cast<Tcl_Size>(get(obj)->values_.size()); }
+
+	static Tcl_Obj *index(Tcl_Obj *obj, Tcl_Size i) { return make_obj(get(obj)->values_[i]); }
+
+	static Tcl_Obj *slice(Tcl_Obj *obj, Tcl_Size first, Tcl_Size last) {
+		vector<T> const &values = get(obj)->values_;
+		return new_obj(new_buffer(vector<T>(values.begin() + first, values.begin() + last + 1)));
+	}
+
+	static Tcl_ObjType type;
+	static packed_ops const ops;
+};
+
+template <typename T>
+Tcl_ObjType packed_type<T>::type = {
+	const_cast<char *>(packed_names<T>::type), // name
+	free_intrep_proc,						   // freeIntRepProc
+	dup_intrep_proc,						   // dupIntRepProc
+	update_string_proc,						   // updateStringProc
+	set_from_any_proc						   // setFromAnyProc
+};
+
+template <typename T> packed_ops const packed_type<T>::ops = {packed_names<T>::command, &type, set_from_any_proc, length, index, slice};
+
+packed_ops const *const all_packed_ops[] = {&packed_type<double>::ops, &packed_type<float>::ops, &packed_type<int32_t>::ops, &packed_type<int64_t>::ops};
+
+packed_ops const *find_packed_ops(Tcl_Obj *obj) {
+	for (packed_ops const *ops : all_packed_ops) {
+		if (obj->typePtr == ops->type) {
+			return ops;
+		}
+	}
+	return 0;
+}
+
+// ns::double list (and the other types)
+extern "C" int packed_make_handler(ClientData cd, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[]) {
+	if (objc != 2) {
+		Tcl_WrongNumArgs(interp, 1, objv, "list");
+		return TCL_ERROR;
+	}
+
+	packed_ops const *ops = static_cast<packed_ops const *>(cd);
+	if (objv[1]->typePtr != ops->type && ops->set_from_any(interp, objv[1]) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	Tcl_SetObjResult(interp, objv[1]);
+	return TCL_OK;
+}
+
+// ns::length array
+extern "C" int packed_length_handler(ClientData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[]) {
+	if (objc != 2) {
+		Tcl_WrongNumArgs(interp, 1, objv, "array");
+		return TCL_ERROR;
+	}
+
+	Tcl_Size n;
+	if (packed_ops const *ops = find_packed_ops(objv[1])) {
+		n = ops->length(objv[1]);
+	} else if (Tcl_ListObjLength(interp, objv[1], &n) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	Tcl_SetObjResult(interp, Tcl_NewWideIntObj(n));
+	return TCL_OK;
+}
+
+// ns::index array i
+// (the result is empty when i is out of range)
+extern "C" int packed_index_handler(ClientData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[]) {
+	if (objc != 3) {
+		Tcl_WrongNumArgs(interp, 1, objv, "array index");
+		return TCL_ERROR;
+	}
+
+	Tcl_Size i;
+	if (Tcl_GetSizeIntFromObj(interp, objv[2], &i) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	if (packed_ops const *ops = find_packed_ops(objv[1])) {
+		if (i >= 0 && i < ops->length(objv[1])) {
+			Tcl_SetObjResult(interp, ops->index(objv[1], i));
+		}
+		return TCL_OK;
+	}
+
+	Tcl_Obj *elem;
+	if (Tcl_ListObjIndex(interp, objv[1], i, &elem) != TCL_OK) {
+		return TCL_ERROR;
+	}
+	if (elem != 0) {
+		Tcl_SetObjResult(interp, elem);
+	}
+	return TCL_OK;
+}
+
+// ns::slice array first last
+// (like lrange, the result of a packed array is packed)
+extern "C" int packed_slice_handler(ClientData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[]) {
+	if (objc != 4) {
+		Tcl_WrongNumArgs(interp, 1, objv, "array first last");
+		return TCL_ERROR;
+	}
+
+	Tcl_Size first, last;
+	if (Tcl_GetSizeIntFromObj(interp, objv[2], &first) != TCL_OK || Tcl_GetSizeIntFromObj(interp, objv[3], &last) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	packed_ops const *ops = find_packed_ops(objv[1]);
+	Tcl_Size n;
+	Tcl_Obj **elems = 0;
+	if (ops != 0) {
+		n = ops->length(objv[1]);
+	} else if (Tcl_ListObjGetElements(interp, objv[1], &n, &elems) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	first = std::max<Tcl_Size>(first, 0);
+	last = std::min<Tcl_Size>(last, n - 1);
+	if (first > last) {
+		first = 0;
+		last = -1;
+	}
+
+	if (ops != 0) {
+		Tcl_SetObjResult(interp, ops->slice(objv[1], first, last));
+	} else {
+		Tcl_SetObjResult(interp, Tcl_NewListObj(last - first + 1, elems + first));
+	}
+	return TCL_OK;
+}
+
+} // namespace
+
+template <typename T> packed_array<T>::packed_array(size_t size) : buf_(packed_type<T>::new_buffer(vector<T>(size))) {
+	obj_ = packed_type<T>::new_obj(buf_);
+	Tcl_IncrRefCount(obj_);
+	++buf_->refs_;
+}
+
+template <typename T> packed_array<T>::packed_array(packed_array const &other) : obj_(other.obj_), buf_(other.buf_) {
+	if (obj_ != 0) {
+		Tcl_IncrRefCount(obj_);
+		++buf_->refs_;
+	}
+}
+
+template <typename T> packed_array<T>::packed_array(packed_array &&other) noexcept : obj_(other.obj_), buf_(other.buf_) {
+	other.obj_ = 0;
+	other.buf_ = 0;
+}
+
+template <typename T> packed_array<T>::~packed_array() {
+	if (obj_ != 0) {
+		Tcl_DecrRefCount(obj_);
+		packed_type<T>::release(buf_);
+	}
+}
+
+template <typename T> packed_array<T> &packed_array<T>::operator=(packed_array other) noexcept {
+	std::swap(obj_, other.obj_);
+	std::swap(buf_, other.buf_);
+	return *this;
+}
+
+// the numbers can be written in place when they are referred to
+// only by this array and by its object, which nobody else uses
+template <typename T> void packed_array<T>::unshare() {
+	if (obj_ != 0 && !Tcl_IsShared(obj_) && obj_->typePtr == &packed_type<T>::type && packed_type<T>::get(obj_) == buf_ && buf_->refs_ == 2) {
+		Tcl_InvalidateStringRep(obj_);
+		return;
+	}
+
+	packed_buffer<T> *b = packed_type<T>::new_buffer(buf_ != 0 ? buf_->values_ : vector<T>());
+	Tcl_Obj *obj = packed_type<T>::new_obj(b);
+	Tcl_IncrRefCount(obj);
+	++b->refs_;
+
+	if (obj_ != 0) {
+		Tcl_DecrRefCount(obj_);
+		packed_type<T>::release(buf_);
+	}
+	obj_ = obj;
+	buf_ = b;
+}
+
+template <typename T> T *packed_array<T>::mutable_data() {
+	unshare();
+	return buf_->values_.data();
+}
+
+template <typename T> void packed_array<T>::resize(size_t size) {
+	unshare();
+	buf_->values_.resize(size);
+}
+
+template <typename T> packed_array<T> tcl_cast<packed_array<T>>::from(Tcl_Interp *interp, Tcl_Obj *obj, bool) {
+	packed_array<T> res;
+	if (convert(interp, obj, res) != TCL_OK) {
+		throw tcl_error(interp);
+	}
+
+	return res;
+}
+
+template <typename T> int tcl_cast<packed_array<T>>::convert(Tcl_Interp *interp, Tcl_Obj *obj, packed_array<T> &res) noexcept {
+	if (obj->typePtr != &packed_type<T>::type && packed_type<T>::set_from_any_proc(interp, obj) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	packed_array<T> a;
+	a.obj_ = obj;
+	a.buf_ = packed_type<T>::get(obj);
+	Tcl_IncrRefCount(a.obj_);
+	++a.buf_->refs_;
+
+	res = std::move(a);
+	return TCL_OK;
+}
+
+template <typename T> Tcl_Obj *details::make_obj(packed_array<T> const &a) noexcept { return a.get_object() != 0 ? a.get_object() : packed_type<T>::new_obj(packed_type<T>::new_buffer(vector<T>())); }
+
+template class Tcl::packed_array<double>;
+template class Tcl::packed_array<float>;
+template class Tcl::packed_array<int32_t>;
+template class Tcl::packed_array<int64_t>;
+
+template struct Tcl::details::tcl_cast<packed_array<double>>;
+template struct Tcl::details::tcl_cast<packed_array<float>>;
+template struct Tcl::details::tcl_cast<packed_array<int32_t>>;
+template struct Tcl::details::tcl_cast<packed_array<int64_t>>;
+
+template Tcl_Obj *Tcl::details::make_obj(packed_array<double> const &) noexcept;
+template Tcl_Obj *Tcl::details::make_obj(packed_array<float> const &) noexcept;
+template Tcl_Obj *Tcl::details::make_obj(packed_array<int32_t> const &) noexcept;
+template Tcl_Obj *Tcl::details::make_obj(packed_array<int64_t> const &) noexcept;
+
+void interpreter::packed_commands(string const &ns) {
+	for (packed_ops const *ops : all_packed_ops) {
+		Tcl_CreateObjCommand(interp_, (ns + "::" + ops->command).c_str(), packed_make_handler, const_cast<packed_ops *>(ops), 0);
+	}
+
+	Tcl_CreateObjCommand(interp_, (ns + "::length").c_str(), packed_length_handler, 0, 0);
+	Tcl_CreateObjCommand(interp_, (ns + "::index").c_str(), packed_index_handler, 0, 0);
+	Tcl_CreateObjCommand(interp_, (ns + "::slice").c_str(), packed_slice_handler, 0, 0);
+}
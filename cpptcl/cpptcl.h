@@ -19,12 +19,23 @@
 #endif
 #endif
 
+#include <array>
 #include <functional>
+#include <iterator>
+#include <limits>
 #include <map>
 #include <memory>
+#include <new>
+#include <optional>
 #include <sstream>
 #include <stdexcept>
+#include <stdint.h>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 //
@@ -38,6 +49,10 @@
 
 #include "tcl.h"
 
+// only the TclOO types are needed here, the TclOO functions
+// are called from cpptcl.cc (through the TclOO stubs table)
+#include "tclOO.h"
+
 /* Check, if Tcl version supports Tcl_Size,
  * which was introduced in Tcl 8.7 and 9.
  */
@@ -73,7 +88,7 @@ class tcl_error : public std::runtime_error {
 // call policies
 
 struct policies {
-	policies() : variadic_(false), usage_("Too few arguments.") {}
+	policies() : variadic_(false), nre_(false), usage_("Too few arguments.") {}
 
 	policies &factory(std::string const &name);
 
@@ -82,11 +97,16 @@ struct policies {
 
 	policies &variadic();
 
+	// the command is created with Tcl_NRCreateCommand
+	// (see interpreter::tail_eval)
+	policies &nre();
+
 	policies &usage(std::string const &message);
 
 	std::string factory_;
 	std::vector<int> sinks_;
 	bool variadic_;
+	bool nre_;
 	std::string usage_;
 };
 
@@ -94,11 +114,249 @@ struct policies {
 policies factory(std::string const &name);
 policies sink(int index);
 policies variadic();
+policies nre();
 policies usage(std::string const &message);
 
 class interpreter;
 class object;
 
+namespace details {
+template <typename T> struct tcl_cast;
+
+// the numbers of a packed array, shared by the Tcl objects
+// and the packed_array values that refer to them
+template <typename T> struct packed_buffer {
+	std::size_t refs_;
+	std::vector<T> values_;
+};
+}
+
+// views of the bytes of Tcl byte arrays, for binary data
+// (like std::span, which is not available in C++17)
+// - a const_byte_span parameter refers directly to the bytes of
+//   the argument, which are valid for the duration of the call
+// - a byte_span parameter is writable; it refers to the bytes of
+//   the argument when that is not shared, and to a private copy
+//   otherwise, so that the writes are never seen by the caller
+// - byte_span(size) allocates a new byte array, which the function
+//   can fill in and return without another copy
+
+class const_byte_span {
+  public:
+	const_byte_span() : data_(0), size_(0) {}
+	const_byte_span(unsigned char const *data, std::size_t size) : data_(data), size_(size) {}
+
+	unsigned char const *data() const { return data_; }
+	std::size_t size() const { return size_; }
+	bool empty() const { return size_ == 0; }
+
+	unsigned char const *begin() const { return data_; }
+	unsigned char const *end() const { return data_ + size_; }
+	unsigned char operator[](std::size_t i) const { return data_[i]; }
+
+  private:
+	unsigned char const *data_;
+	std::size_t size_;
+};
+
+// the span keeps a reference to the byte array object
+// (copies of the span refer to the same bytes)
+class byte_span {
+  public:
+	byte_span() : obj_(0), data_(0), size_(0) {}
+	explicit byte_span(std::size_t size);
+	byte_span(byte_span const &other);
+	byte_span(byte_span &&other) noexcept;
+	~byte_span();
+
+	byte_span &operator=(byte_span other) noexcept;
+
+	unsigned char *data() const { return data_; }
+	std::size_t size() const { return size_; }
+	bool empty() const { return size_ == 0; }
+
+	unsigned char *begin() const { return data_; }
+	unsigned char *end() const { return data_ + size_; }
+	unsigned char &operator[](std::size_t i) const { return data_[i]; }
+
+	operator const_byte_span() const { return const_byte_span(data_, size_); }
+
+	// changes the size, keeping the leading bytes
+	// (a span that shares its bytes with others gets its own copy)
+	void resize(std::size_t size);
+
+	// the byte array object, or 0 for the default constructed span
+	Tcl_Obj *get_object() const { return obj_; }
+
+  private:
+	friend struct details::tcl_cast<byte_span>;
+
+	// takes over the reference to the unshared obj
+	byte_span(Tcl_Obj *obj, unsigned char *data, std::size_t size) : obj_(obj), data_(data), size_(size) {}
+
+	Tcl_Obj *obj_;
+	unsigned char *data_;
+	std::size_t size_;
+};
+
+// builder for string results, which is written directly into
+// the buffer of the result object
+// (so that a large result is not built in a std::string first
+// and then copied; return it from the function to make it the result)
+
+class result_writer {
+  public:
+	result_writer();
+	result_writer(result_writer &&other) noexcept;
+	result_writer(result_writer const &) = delete;
+	~result_writer();
+
+	result_writer &operator=(result_writer const &) = delete;
+
+	// makes room for size bytes in total
+	void reserve(std::size_t size);
+
+	// adds n bytes at the end and returns them, to be written by the caller
+	// (the pointer is valid until the next change of the size)
+	char *extend(std::size_t n);
+
+	// truncates (or extends) the contents to size bytes
+	void resize(std::size_t size);
+
+	result_writer &append(char const *s, std::size_t n);
+
+	result_writer &operator<<(std::string_view s) { return append(s.data(), s.size()); }
+	result_writer &operator<<(char c) { return append(&c, 1); }
+
+	// formatted the way Tcl formats doubles
+	result_writer &operator<<(double d);
+
+	template <typename T> typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value && !std::is_same<T, char>::value, result_writer &>::type operator<<(T i) {
+		if constexpr (std::is_signed<T>::value) {
+			return append_integer(i);
+		} else {
+			return append_unsigned(i);
+		}
+	}
+
+	std::size_t size() const { return obj_->length; }
+	char const *data() const { return obj_->bytes; }
+
+	Tcl_Obj *get_object() const { return obj_; }
+
+  private:
+	result_writer &append_integer(long long i);
+	result_writer &append_unsigned(unsigned long long i);
+
+	Tcl_Obj *obj_;
+	std::size_t capacity_;
+};
+
+// C++ value types kept in the internal representation of Tcl objects
+// - to use T as a parameter and result type, specialize value_type<T>:
+//     static constexpr char const *name = "...";   (name of the Tcl_ObjType)
+//     static std::string format(T const &v);       (the string form)
+//     static int parse(Tcl_Interp *interp, Tcl_Obj *obj, T &res);
+//   parse() returns TCL_OK or TCL_ERROR, with the message in interp
+//   (when interp is not 0)
+// - the value is parsed only once, and the string form is made only
+//   when the script asks for it, so passing the value between the
+//   bound functions does not convert it again
+// - small trivially copyable values are stored in the Tcl object itself,
+//   the others are allocated on the heap
+template <typename T> struct value_type {};
+
+// enum types, converted by name
+// - to use E as a parameter and result type, specialize enum_type<E>:
+//     static constexpr char const *name = "...";   (used in the error messages)
+//     static constexpr enum_value<E> values[] = {{"name", E::value}, ...};
+// - the names must match exactly; they are looked up with
+//   Tcl_GetIndexFromObjStruct, which caches the index in the argument
+// - the results are the name objects, shared per interpreter
+//   (a value without a name is given as its number)
+template <typename E> struct enum_value {
+	char const *name;
+	E value;
+};
+
+template <typename E> struct enum_type {};
+
+// C++ structs, converted to and from Tcl dicts field by field
+// - to use S as a parameter and result type, specialize struct_type<S>:
+//     static void describe(struct_<S> &s) { s.field("lat", &S::lat).field("lon", &S::lon); }
+//   (the fields can be of any of the supported types)
+// - the description is made once, and the key objects are then shared
+//   by all the conversions in the thread
+// - a dict without one of the fields is an error, other keys are ignored
+template <class S> class struct_;
+
+template <typename S> struct struct_type {};
+
+// constant string results
+// (the Tcl object of each constant is created once per interpreter
+// and then shared by all the results that give it)
+class constant_string {
+  public:
+	explicit constant_string(std::string s);
+
+	std::string const &str() const { return str_; }
+	std::size_t index() const { return index_; }
+
+  private:
+	std::string str_;
+	std::size_t index_;
+};
+
+// packed arrays of numbers, for long numeric series
+// (T is double, float, int32_t or int64_t)
+// - the numbers are kept in one buffer in the internal representation
+//   of the Tcl object, and the list form is made only when the script
+//   asks for it
+// - a packed_array parameter gives the numbers with no conversion when
+//   the argument is a packed array of the same type already; a list is
+//   converted once, and the argument then keeps the packed form
+// - the writable access copies the numbers first, when they are shared
+//   with other objects (copy on write)
+// - see interpreter::packed_commands for using them in scripts
+
+template <typename T> class packed_array {
+  public:
+	packed_array() : obj_(0), buf_(0) {}
+	explicit packed_array(std::size_t size);
+	packed_array(packed_array const &other);
+	packed_array(packed_array &&other) noexcept;
+	~packed_array();
+
+	packed_array &operator=(packed_array other) noexcept;
+
+	std::size_t size() const { return buf_ != 0 ? buf_->values_.size() : 0; }
+	bool empty() const { return size() == 0; }
+
+	T const *data() const { return buf_ != 0 ? buf_->values_.data() : 0; }
+	T const *begin() const { return data(); }
+	T const *end() const { return data() + size(); }
+	T operator[](std::size_t i) const { return buf_->values_[i]; }
+
+	// writable access
+	// (the pointer is valid until the next change of the size)
+	T *mutable_data();
+
+	// changes the size, new numbers are 0
+	void resize(std::size_t size);
+
+	// the Tcl object, or 0 for the default constructed array
+	Tcl_Obj *get_object() const { return obj_; }
+
+  private:
+	friend struct details::tcl_cast<packed_array<T>>;
+
+	// makes sure that the array is the only owner of the object and buffer
+	void unshare();
+
+	Tcl_Obj *obj_;
+	details::packed_buffer<T> *buf_;
+};
+
 namespace details {
 
 // wrapper for the evaluation result
@@ -118,14 +376,105 @@ class result {
 };
 
 // helper functions used to set the result value
-
-void set_result(Tcl_Interp *interp, bool b);
-void set_result(Tcl_Interp *interp, int i);
-void set_result(Tcl_Interp *interp, long i);
-void set_result(Tcl_Interp *interp, double d);
-void set_result(Tcl_Interp *interp, std::string const &s);
+// - the result object of the interpreter is reused when it is not shared
+// - booleans, small integers and constant strings are otherwise given
+//   as objects shared per interpreter
+
+void set_result(Tcl_Interp *interp, bool b) noexcept;
+void set_result(Tcl_Interp *interp, int i) noexcept;
+void set_result(Tcl_Interp *interp, long i) noexcept;
+void set_result(Tcl_Interp *interp, double d) noexcept;
+void set_result(Tcl_Interp *interp, std::string const &s) noexcept;
+void set_result(Tcl_Interp *interp, std::string_view s) noexcept;
+void set_result(Tcl_Interp *interp, char const *s) noexcept;
 void set_result(Tcl_Interp *interp, void *p);
-void set_result(Tcl_Interp *interp, object const &o);
+void set_result(Tcl_Interp *interp, object const &o) noexcept;
+void set_result(Tcl_Interp *interp, const_byte_span s) noexcept;
+void set_result(Tcl_Interp *interp, byte_span const &s) noexcept;
+void set_result(Tcl_Interp *interp, result_writer const &w) noexcept;
+void set_result(Tcl_Interp *interp, constant_string const &s) noexcept;
+
+// the other integer types are passed through Tcl_WideInt
+// (unsigned values that do not fit in it are given as decimal strings)
+template <typename T> struct is_wide_integer {
+	static bool const value = std::is_integral<T>::value && !std::is_same<T, bool>::value && !std::is_same<T, char>::value && !std::is_same<T, int>::value && !std::is_same<T, long>::value;
+};
+
+// helper functions used to create Tcl objects from values
+// (for the elements of compound results, like lists)
+
+Tcl_Obj *make_obj(bool b) noexcept;
+Tcl_Obj *make_obj(int i) noexcept;
+Tcl_Obj *make_obj(long i) noexcept;
+Tcl_Obj *make_obj(double d) noexcept;
+Tcl_Obj *make_obj(std::string const &s) noexcept;
+Tcl_Obj *make_obj(std::string_view s) noexcept;
+Tcl_Obj *make_obj(char const *s) noexcept;
+Tcl_Obj *make_obj(object const &o) noexcept;
+Tcl_Obj *make_obj(const_byte_span s) noexcept;
+Tcl_Obj *make_obj(byte_span const &s) noexcept;
+Tcl_Obj *make_obj(result_writer const &w) noexcept;
+Tcl_Obj *make_obj(constant_string const &s) noexcept;
+
+// shortest string that reads back as the same double, laid out
+// like Tcl_PrintDouble does it; returns the length
+// (buf must have TCL_DOUBLE_SPACE chars)
+int format_double(double d, char *buf) noexcept;
+
+// list of doubles, with the string rep made in one pass
+Tcl_Obj *make_double_list_obj(double const *values, std::size_t n) noexcept;
+
+Tcl_Obj *make_wide_obj(Tcl_WideInt i) noexcept;
+Tcl_Obj *make_unsigned_wide_obj(Tcl_WideUInt i) noexcept;
+
+template <typename T> typename std::enable_if<is_wide_integer<T>::value, Tcl_Obj *>::type make_obj(T i) noexcept {
+	if constexpr (std::is_signed<T>::value) {
+		return make_wide_obj(i);
+	} else {
+		return make_unsigned_wide_obj(i);
+	}
+}
+
+template <typename T> typename std::enable_if<is_wide_integer<T>::value>::type set_result(Tcl_Interp *interp, T i) noexcept { Tcl_SetObjResult(interp, make_obj(i)); }
+
+// helpers for pointer handles
+// - pointers are passed to Tcl as 'pXXX' values, which refer to
+//   the entry of the pointer in the registry of the thread
+// - own_pointer_handle keeps the entry of a class object until
+//   release_pointer_handle is used when the object is deleted,
+//   so that the handles that still refer to it are rejected;
+//   other pointers of the types given to add_class_tag must then
+//   have a live entry when they are given as strings
+// - with exact set, handles of other types are rejected
+//   (pointer parameters accept also handles of derived classes)
+Tcl_Obj *new_pointer_handle(void *p, void const *tag);
+void *get_pointer_handle(Tcl_Obj *obj, void const *tag, bool exact = false);
+int get_pointer_handle(Tcl_Interp *interp, Tcl_Obj *obj, void const *tag, void *&p, bool exact = false) noexcept;
+void own_pointer_handle(Tcl_Obj *obj, void const *tag);
+void release_pointer_handle(void *p);
+void add_class_tag(void const *tag);
+
+// unique tag identifying the pointee type of pointer handles
+// (unlike typeid, it works also for incomplete types)
+template <typename T> struct type_tag {
+	static void const *get() { return &id_; }
+
+	static char const id_;
+};
+
+template <typename T> char const type_tag<T>::id_ = 0;
+
+// void pointers are not typed
+template <> struct type_tag<void> {
+	static void const *get() { return 0; }
+};
+
+template <typename T> Tcl_Obj *make_obj(T *p) {
+	typedef typename std::remove_cv<T>::type U;
+	return new_pointer_handle(const_cast<U *>(p), type_tag<U>::get());
+}
+
+template <typename T> void set_result(Tcl_Interp *interp, T *p) { Tcl_SetObjResult(interp, make_obj(p)); }
 
 }
 
@@ -145,6 +494,10 @@ namespace details {
 // (throws tcl_error when not met)
 void check_params_no(int objc, int required, const std::string &message);
 
+// helper for reporting the wrong number of parameters
+// (sets the message as the result and returns TCL_ERROR)
+int params_no_error(Tcl_Interp *interp, const std::string &message) noexcept;
+
 // helper for gathering optional params in variadic functions
 object get_var_params(Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[], int from, policies const &pol);
 
@@ -153,66 +506,137 @@ class callback_base {
   public:
 	virtual ~callback_base() {}
 
-	virtual void invoke(Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[], policies const &pol) = 0;
+	// returns TCL_ERROR (with the message in the interpreter)
+	// when the arguments are wrong
+	virtual int invoke(Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[], policies const &pol) = 0;
+};
+
+// record of a single free function command
+// - it is given to Tcl as the ClientData of the command,
+//   so that dispatching the call does not need any lookup
+// - the callback is kept inside the record (see function_record_of),
+//   so that a function object and its captured state are allocated
+//   together with the command
+class function_record {
+  public:
+	explicit function_record(policies const &pol) : cb_(0), pol_(pol) {}
+	virtual ~function_record() {}
+
+	callback_base *cb_;
+	policies pol_;
+};
+
+template <class CB> class function_record_of : public function_record {
+  public:
+	template <typename... Args> explicit function_record_of(policies const &pol, Args &&... args) : function_record(pol), callback_(std::forward<Args>(args)...) { cb_ = &callback_; }
+
+  private:
+	CB callback_;
+};
+
+// continuation of a tail evaluation (see interpreter::tail_eval)
+class continuation_base {
+  public:
+	virtual ~continuation_base() {}
+
+	virtual void invoke(Tcl_Interp *interp, object const &result) = 0;
 };
 
 // base class for object command handlers
-// and for class handlers
 class object_cmd_base {
   public:
 	// destructor not needed, but exists to shut up the compiler warnings
 	virtual ~object_cmd_base() {}
 
-	virtual void invoke(void *p, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[], policies const &pol) = 0;
+	// returns TCL_ERROR (with the message in the interpreter)
+	// when the arguments are wrong
+	virtual int invoke(void *p, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[], policies const &pol) = 0;
+};
+
+// single method of the given class
+// - the policies are kept inline, next to the handler
+struct method_entry {
+	method_entry(std::string const &name, std::unique_ptr<object_cmd_base> cmd, policies const &pol);
+
+	std::string name_;
+
+	// the handler is null for the builtin -delete method
+	std::unique_ptr<object_cmd_base> cmd_;
+
+	policies pol_;
 };
 
 // base class for all class handlers, still abstract
-class class_handler_base : public object_cmd_base {
+class class_handler_base {
   public:
-	typedef std::map<std::string, policies> policies_map_type;
-
 	class_handler_base();
+	virtual ~class_handler_base() {}
 
-	void register_method(std::string const &name, std::shared_ptr<object_cmd_base> ocb, policies const &p);
+	void register_method(std::string const &name, std::unique_ptr<object_cmd_base> ocb, policies const &p);
 
-	policies &get_policies(std::string const &name);
+	// finds the method named by the given object
+	// - the result is cached in the object, so that the following
+	//   calls with the same object do not need any lookup
+	method_entry const &get_method(Tcl_Obj *name);
 
-  protected:
-	typedef std::map<std::string, std::shared_ptr<object_cmd_base> > method_map_type;
+	// deletes the object of the given class
+	virtual void destroy(void *p) = 0;
 
-	// a map of methods for the given class
-	method_map_type methods_;
+	// the type tag of the pointers to objects of the class
+	void const *tag() const { return tag_; }
 
-	policies_map_type policies_;
-};
+	// in handle mode, the objects are only handle values
+	// and do not have their own commands
+	void set_handle_mode() { handle_mode_ = true; }
+	bool handle_mode() const { return handle_mode_; }
 
-// class handler - responsible for executing class methods
-template <class C> class class_handler : public class_handler_base {
-  public:
-	virtual void invoke(void *pv, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[], policies const &pol) {
-		C *p = static_cast<C *>(pv);
+	// exposes the class as the given TclOO class
+	// - from now on, the methods are registered with Tcl_NewMethod
+	void set_oo_class(Tcl_Interp *interp, Tcl_Class cls);
 
-		if (objc < 2) {
-			throw tcl_error(pol.usage_);
-		}
+	// the type of the metadata that keeps the C++ object
+	// in the instances of the TclOO class
+	Tcl_ObjectMetadataType const *oo_metadata_type() const { return &oo_metadata_; }
 
-		std::string methodName(Tcl_GetString(objv[1]));
+  protected:
+	// builds the index of the method table
+	// (done lazily, when the first method is looked up after
+	// the last registration)
+	void seal();
 
-		if (methodName == "-delete") {
-			Tcl_DeleteCommand(interp, Tcl_GetString(objv[0]));
-			delete p;
-			return;
-		}
+	// slot of the open addressing index of the method table
+	struct method_slot {
+		uint32_t hash_;
+		uint32_t index_; // index of the method + 1, 0 for empty slots
+	};
 
-		// dispatch on the method name
+	// the methods of the given class, in the order of registration
+	std::vector<method_entry> methods_;
 
-		method_map_type::iterator it = methods_.find(methodName);
-		if (it == methods_.end()) {
-			throw tcl_error("Method " + methodName + " not found.");
-		}
+	std::vector<method_slot> slots_;
+	bool sealed_;
+
+	// identifies the current state of the methods table,
+	// unique among all class handlers
+	unsigned long epoch_;
 
-		it->second->invoke(pv, interp, objc, objv, pol);
+	void const *tag_;
+	bool handle_mode_;
+
+	Tcl_Interp *oo_interp_;
+	Tcl_Class oo_class_;
+	Tcl_ObjectMetadataType oo_metadata_;
+};
+
+// class handler - responsible for deleting class objects
+template <class C> class class_handler : public class_handler_base {
+  public:
+	class_handler() {
+		tag_ = type_tag<C>::get();
+		add_class_tag(tag_);
 	}
+
+	virtual void destroy(void *p) { delete static_cast<C *>(p); }
 };
 
 }
@@ -222,15 +646,15 @@ template <class C> class class_handler : public class_handler_base {
 // factory functions for creating class objects
 #include "cpptcl/details/constructors.h"
 
+// helper meta functions for unpacking the parameters
+#include "cpptcl/details/metahelpers.h"
+
 // actual callback envelopes
 #include "cpptcl/details/callbacks.h"
 
 // actual method envelopes
 #include "cpptcl/details/methods.h"
 
-// helper meta function for figuring appropriate constructor callback
-#include "cpptcl/details/metahelpers.h"
-
 namespace Tcl {
 
 namespace details {
@@ -242,103 +666,19 @@ template <class C> class class_definer {
   public:
 	class_definer(std::shared_ptr<class_handler<C>> ch) : ch_(ch) {}
 
-	template <typename R> class_definer &def(std::string const &name, R (C::*f)(), policies const &p = policies()) {
-		ch_->register_method(name, std::shared_ptr<details::object_cmd_base>(new details::method0<C, R>(f)), p);
-		return *this;
-	}
-
-	template <typename R> class_definer &def(std::string const &name, R (C::*f)() const, policies const &p = policies()) {
-		ch_->register_method(name, std::shared_ptr<details::object_cmd_base>(new details::method0<C, R>(f)), p);
-		return *this;
-	}
-
-	template <typename R, typename T1> class_definer &def(std::string const &name, R (C::*f)(T1), policies const &p = policies()) {
-		ch_->register_method(name, std::shared_ptr<details::object_cmd_base>(new details::method1<C, R, T1>(f)), p);
-		return *this;
-	}
-
-	template <typename R, typename T1> class_definer &def(std::string const &name, R (C::*f)(T1) const, policies const &p = policies()) {
-		ch_->register_method(name, std::shared_ptr<details::object_cmd_base>(new details::method1<C, R, T1>(f)), p);
-		return *this;
-	}
-
-	template <typename R, typename T1, typename T2> class_definer &def(std::string const &name, R (C::*f)(T1, T2), policies const &p = policies()) {
-		ch_->register_method(name, std::shared_ptr<details::object_cmd_base>(new details::method2<C, R, T1, T2>(f)), p);
-		return *this;
-	}
-
-	template <typename R, typename T1, typename T2> class_definer &def(std::string const &name, R (C::*f)(T1, T2) const, policies const &p = policies()) {
-		ch_->register_method(name, std::shared_ptr<details::object_cmd_base>(new details::method2<C, R, T1, T2>(f)), p);
-		return *this;
-	}
-
-	template <typename R, typename T1, typename T2, typename T3> class_definer &def(std::string const &name, R (C::*f)(T1, T2, T3), policies const &p = policies()) {
-		ch_->register_method(name, std::shared_ptr<details::object_cmd_base>(new details::method3<C, R, T1, T2, T3>(f)), p);
-		return *this;
-	}
-
-	template <typename R, typename T1, typename T2, typename T3> class_definer &def(std::string const &name, R (C::*f)(T1, T2, T3) const, policies const &p = policies()) {
-		ch_->register_method(name, std::shared_ptr<details::object_cmd_base>(new details::method3<C, R, T1, T2, T3>(f)), p);
-		return *this;
-	}
-
-	template <typename R, typename T1, typename T2, typename T3, typename T4> class_definer &def(std::string const &name, R (C::*f)(T1, T2, T3, T4), policies const &p = policies()) {
-		ch_->register_method(name, std::shared_ptr<details::object_cmd_base>(new details::method4<C, R, T1, T2, T3, T4>(f)), p);
-		return *this;
-	}
-
-	template <typename R, typename T1, typename T2, typename T3, typename T4> class_definer &def(std::string const &name, R (C::*f)(T1, T2, T3, T4) const, policies const &p = policies()) {
-		ch_->register_method(name, std::shared_ptr<details::object_cmd_base>(new details::method4<C, R, T1, T2, T3, T4>(f)), p);
-		return *this;
-	}
-
-	template <typename R, typename T1, typename T2, typename T3, typename T4, typename T5> class_definer &def(std::string const &name, R (C::*f)(T1, T2, T3, T4, T5), policies const &p = policies()) {
-		ch_->register_method(name, std::shared_ptr<details::object_cmd_base>(new details::method5<C, R, T1, T2, T3, T4, T5>(f)), p);
-		return *this;
-	}
-
-	template <typename R, typename T1, typename T2, typename T3, typename T4, typename T5> class_definer &def(std::string const &name, R (C::*f)(T1, T2, T3, T4, T5) const, policies const &p = policies()) {
-		ch_->register_method(name, std::shared_ptr<details::object_cmd_base>(new details::method5<C, R, T1, T2, T3, T4, T5>(f)), p);
-		return *this;
-	}
-
-	template <typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6> class_definer &def(std::string const &name, R (C::*f)(T1, T2, T3, T4, T5, T6), policies const &p = policies()) {
-		ch_->register_method(name, std::shared_ptr<details::object_cmd_base>(new details::method6<C, R, T1, T2, T3, T4, T5, T6>(f)), p);
+	template <typename R, typename... Ts> class_definer &def(std::string const &name, R (C::*f)(Ts...), policies const &p = policies()) {
+		ch_->register_method(name, std::unique_ptr<details::object_cmd_base>(new details::method<C, R (C::*)(Ts...), R, Ts...>(f)), p);
 		return *this;
 	}
 
-	template <typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6> class_definer &def(std::string const &name, R (C::*f)(T1, T2, T3, T4, T5, T6) const, policies const &p = policies()) {
-		ch_->register_method(name, std::shared_ptr<details::object_cmd_base>(new details::method6<C, R, T1, T2, T3, T4, T5, T6>(f)), p);
+	template <typename R, typename... Ts> class_definer &def(std::string const &name, R (C::*f)(Ts...) const, policies const &p = policies()) {
+		ch_->register_method(name, std::unique_ptr<details::object_cmd_base>(new details::method<C, R (C::*)(Ts...) const, R, Ts...>(f)), p);
 		return *this;
 	}
 
-	template <typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7> class_definer &def(std::string const &name, R (C::*f)(T1, T2, T3, T4, T5, T6, T7), policies const &p = policies()) {
-		ch_->register_method(name, std::shared_ptr<details::object_cmd_base>(new details::method7<C, R, T1, T2, T3, T4, T5, T6, T7>(f)), p);
-		return *this;
-	}
-
-	template <typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7> class_definer &def(std::string const &name, R (C::*f)(T1, T2, T3, T4, T5, T6, T7) const, policies const &p = policies()) {
-		ch_->register_method(name, std::shared_ptr<details::object_cmd_base>(new details::method7<C, R, T1, T2, T3, T4, T5, T6, T7>(f)), p);
-		return *this;
-	}
-
-	template <typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7, typename T8> class_definer &def(std::string const &name, R (C::*f)(T1, T2, T3, T4, T5, T6, T7, T8), policies const &p = policies()) {
-		ch_->register_method(name, std::shared_ptr<details::object_cmd_base>(new details::method8<C, R, T1, T2, T3, T4, T5, T6, T7, T8>(f)), p);
-		return *this;
-	}
-
-	template <typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7, typename T8> class_definer &def(std::string const &name, R (C::*f)(T1, T2, T3, T4, T5, T6, T7, T8) const, policies const &p = policies()) {
-		ch_->register_method(name, std::shared_ptr<details::object_cmd_base>(new details::method8<C, R, T1, T2, T3, T4, T5, T6, T7, T8>(f)), p);
-		return *this;
-	}
-
-	template <typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7, typename T8, typename T9> class_definer &def(std::string const &name, R (C::*f)(T1, T2, T3, T4, T5, T6, T7, T8, T9), policies const &p = policies()) {
-		ch_->register_method(name, std::shared_ptr<details::object_cmd_base>(new details::method9<C, R, T1, T2, T3, T4, T5, T6, T7, T8, T9>(f)), p);
-		return *this;
-	}
-
-	template <typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7, typename T8, typename T9> class_definer &def(std::string const &name, R (C::*f)(T1, T2, T3, T4, T5, T6, T7, T8, T9) const, policies const &p = policies()) {
-		ch_->register_method(name, std::shared_ptr<details::object_cmd_base>(new details::method9<C, R, T1, T2, T3, T4, T5, T6, T7, T8, T9>(f)), p);
+	// lambdas and other function objects, taking the object as C & or C *
+	template <class F, typename = decltype(&std::decay_t<F>::operator())> class_definer &def(std::string const &name, F &&f, policies const &p = policies()) {
+		ch_->register_method(name, std::unique_ptr<details::object_cmd_base>(new details::functor_method<C, std::decay_t<F>>(std::forward<F>(f))), p);
 		return *this;
 	}
 
@@ -349,7 +689,7 @@ template <class C> class class_definer {
 } // namespace details
 
 // init type for defining class constructors
-template <typename T1 = void, typename T2 = void, typename T3 = void, typename T4 = void, typename T5 = void, typename T6 = void, typename T7 = void, typename T8 = void, typename T9 = void> class init {};
+template <typename... Ts> class init {};
 
 // no_init type and object - to define classes without constructors
 namespace details {
@@ -385,54 +725,80 @@ class interpreter {
 
 	// free function definitions
 
-	template <typename R> void def(std::string const &name, R (*f)(), policies const &p = policies()) { add_function(name, std::shared_ptr<details::callback_base>(new details::callback0<R>(f)), p); }
+	template <typename R, typename... Ts> void def(std::string const &name, R (*f)(Ts...), policies const &p = policies()) { add_function(name, std::unique_ptr<details::function_record>(new details::function_record_of<details::callback<R, Ts...>>(p, f))); }
 
-	template <typename R, typename T1> void def(std::string const &name, R (*f)(T1), policies const &p = policies()) { add_function(name, std::shared_ptr<details::callback_base>(new details::callback1<R, T1>(f)), p); }
+	// lambdas, std::function and other function objects
+	template <class F, typename = decltype(&std::decay_t<F>::operator())> void def(std::string const &name, F &&f, policies const &p = policies()) { add_function(name, std::unique_ptr<details::function_record>(new details::function_record_of<details::functor_callback<std::decay_t<F>>>(p, std::forward<F>(f)))); }
 
-	template <typename R, typename T1, typename T2> void def(std::string const &name, R (*f)(T1, T2), policies const &p = policies()) { add_function(name, std::shared_ptr<details::callback_base>(new details::callback2<R, T1, T2>(f)), p); }
+	// free function known at compile time, called without the generic
+	// callback machinery (no policies are supported in this form)
+	template <auto F> void def(std::string const &name) { add_command(name, &details::trampoline<F>::command); }
 
-	template <typename R, typename T1, typename T2, typename T3> void def(std::string const &name, R (*f)(T1, T2, T3), policies const &p = policies()) { add_function(name, std::shared_ptr<details::callback_base>(new details::callback3<R, T1, T2, T3>(f)), p); }
+	// class definitions
 
-	template <typename R, typename T1, typename T2, typename T3, typename T4> void def(std::string const &name, R (*f)(T1, T2, T3, T4), policies const &p = policies()) { add_function(name, std::shared_ptr<details::callback_base>(new details::callback4<R, T1, T2, T3, T4>(f)), p); }
+	template <class C> details::class_definer<C> class_(std::string const &name) {
+		std::shared_ptr<details::class_handler<C>> ch(new details::class_handler<C>());
 
-	template <typename R, typename T1, typename T2, typename T3, typename T4, typename T5> void def(std::string const &name, R (*f)(T1, T2, T3, T4, T5), policies const &p = policies()) { add_function(name, std::shared_ptr<details::callback_base>(new details::callback5<R, T1, T2, T3, T4, T5>(f)), p); }
+		add_class(name, ch);
 
-	template <typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6> void def(std::string const &name, R (*f)(T1, T2, T3, T4, T5, T6), policies const &p = policies()) { add_function(name, std::shared_ptr<details::callback_base>(new details::callback6<R, T1, T2, T3, T4, T5, T6>(f)), p); }
+		add_constructor(name, ch, std::shared_ptr<details::callback_base>(new details::callback<C *>(&details::construct<C>::doit)));
 
-	template <typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7> void def(std::string const &name, R (*f)(T1, T2, T3, T4, T5, T6, T7), policies const &p = policies()) { add_function(name, std::shared_ptr<details::callback_base>(new details::callback7<R, T1, T2, T3, T4, T5, T6, T7>(f)), p); }
+		return details::class_definer<C>(ch);
+	}
 
-	template <typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7, typename T8> void def(std::string const &name, R (*f)(T1, T2, T3, T4, T5, T6, T7, T8), policies const &p = policies()) { add_function(name, std::shared_ptr<details::callback_base>(new details::callback8<R, T1, T2, T3, T4, T5, T6, T7, T8>(f)), p); }
+	template <class C, typename... Ts> details::class_definer<C> class_(std::string const &name, init<Ts...> const &, policies const &p = policies()) {
+		std::shared_ptr<details::class_handler<C>> ch(new details::class_handler<C>());
 
-	template <typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7, typename T8, typename T9> void def(std::string const &name, R (*f)(T1, T2, T3, T4, T5, T6, T7, T8, T9), policies const &p = policies()) { add_function(name, std::shared_ptr<details::callback_base>(new details::callback9<R, T1, T2, T3, T4, T5, T6, T7, T8, T9>(f)), p); }
+		add_class(name, ch);
 
-	// class definitions
+		add_constructor(name, ch, std::shared_ptr<details::callback_base>(new details::callback<C *, Ts...>(&details::construct<C, Ts...>::doit)), p);
 
-	template <class C> details::class_definer<C> class_(std::string const &name) {
+		return details::class_definer<C>(ch);
+	}
+
+	template <class C> details::class_definer<C> class_(std::string const &name, details::no_init_type const &) {
 		std::shared_ptr<details::class_handler<C>> ch(new details::class_handler<C>());
 
 		add_class(name, ch);
 
-		add_constructor(name, ch, std::shared_ptr<details::callback_base>(new details::callback0<C *>(&details::construct<C, void, void, void, void, void, void, void, void, void>::doit)));
-
 		return details::class_definer<C>(ch);
 	}
 
-	template <class C, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7, typename T8, typename T9> details::class_definer<C> class_(std::string const &name, init<T1, T2, T3, T4, T5, T6, T7, T8, T9> const &, policies const &p = policies()) {
-		typedef typename details::get_callback_type_for_construct<C, T1, T2, T3, T4, T5, T6, T7, T8, T9>::type callback_type;
+	// class definitions in handle mode
+	// - there is a single command for the class and the objects are
+	//   only handle values, used as: Name new ..., Name method $h ...
+	//   and Name -delete $h
+	template <class C> details::class_definer<C> handle_class_(std::string const &name) {
+		std::shared_ptr<details::class_handler<C>> ch(new details::class_handler<C>());
+
+		add_handle_class(name, ch, std::shared_ptr<details::callback_base>(new details::callback<C *>(&details::construct<C>::doit)));
 
+		return details::class_definer<C>(ch);
+	}
+
+	template <class C, typename... Ts> details::class_definer<C> handle_class_(std::string const &name, init<Ts...> const &, policies const &p = policies()) {
 		std::shared_ptr<details::class_handler<C>> ch(new details::class_handler<C>());
 
-		add_class(name, ch);
+		add_handle_class(name, ch, std::shared_ptr<details::callback_base>(new details::callback<C *, Ts...>(&details::construct<C, Ts...>::doit)), p);
+
+		return details::class_definer<C>(ch);
+	}
 
-		add_constructor(name, ch, std::shared_ptr<details::callback_base>(new callback_type(&details::construct<C, T1, T2, T3, T4, T5, T6, T7, T8, T9>::doit)), p);
+	// TclOO class definitions
+	// - the methods are dispatched by TclOO, the objects are deleted
+	//   with the destroy method and the class can be subclassed in Tcl
+	template <class C> details::class_definer<C> oo_class_(std::string const &name) {
+		std::shared_ptr<details::class_handler<C>> ch(new details::class_handler<C>());
+
+		add_oo_class(name, ch, std::shared_ptr<details::callback_base>(new details::callback<C *>(&details::construct<C>::doit)));
 
 		return details::class_definer<C>(ch);
 	}
 
-	template <class C> details::class_definer<C> class_(std::string const &name, details::no_init_type const &) {
+	template <class C, typename... Ts> details::class_definer<C> oo_class_(std::string const &name, init<Ts...> const &, policies const &p = policies()) {
 		std::shared_ptr<details::class_handler<C>> ch(new details::class_handler<C>());
 
-		add_class(name, ch);
+		add_oo_class(name, ch, std::shared_ptr<details::callback_base>(new details::callback<C *, Ts...>(&details::construct<C, Ts...>::doit)), p);
 
 		return details::class_definer<C>(ch);
 	}
@@ -446,6 +812,16 @@ class interpreter {
 	// the InputIterator should give object& or Tcl_Obj* when dereferenced
 	template <class InputIterator> details::result eval(InputIterator first, InputIterator last);
 
+	// tail evaluation, only in commands defined with the nre policy
+	// - the script is evaluated after the current command returns,
+	//   without nesting on the C stack, and its result becomes
+	//   the result of the command
+	// - the optional function is then called with the result of the
+	//   script; it can replace the result or schedule another tail
+	//   evaluation
+	void tail_eval(object const &script) { schedule_tail_eval(script, std::unique_ptr<details::continuation_base>()); }
+	template <class F> void tail_eval(object const &script, F &&then) { schedule_tail_eval(script, std::unique_ptr<details::continuation_base>(new details::continuation<std::decay_t<F>>(std::forward<F>(then)))); }
+
 	// Get a variable from TCL interpreter with Tcl_GetVar
 	details::result getVar(std::string const &scalarTclVariable);
 	details::result getVar(std::string const &arrayTclVariable, std::string const &arrayIndex);
@@ -463,18 +839,32 @@ class interpreter {
 	// create a namespace
 	void create_namespace(std::string const &name);
 
+	// commands for the packed arrays, in the given namespace
+	// - double, float, int32 and int64 make a packed array from a list
+	// - length, index and slice read it without making the list
+	//   (they accept ordinary lists too)
+	void packed_commands(std::string const &ns = "packed");
+
 	// helper for cleaning up callbacks in non-managed interpreters
 	static void clear_definitions(Tcl_Interp *);
 
   private:
 	void operator=(const interpreter &);
 
-	void add_function(std::string const &name, std::shared_ptr<details::callback_base> cb, policies const &p = policies());
+	void add_function(std::string const &name, std::unique_ptr<details::function_record> rec);
+
+	void schedule_tail_eval(object const &script, std::unique_ptr<details::continuation_base> then);
+
+	void add_command(std::string const &name, Tcl_ObjCmdProc *proc);
 
 	void add_class(std::string const &name, std::shared_ptr<details::class_handler_base> chb);
 
 	void add_constructor(std::string const &name, std::shared_ptr<details::class_handler_base> chb, std::shared_ptr<details::callback_base> cb, policies const &p = policies());
 
+	void add_handle_class(std::string const &name, std::shared_ptr<details::class_handler_base> chb, std::shared_ptr<details::callback_base> cb, policies const &p = policies());
+
+	void add_oo_class(std::string const &name, std::shared_ptr<details::class_handler_base> chb, std::shared_ptr<details::callback_base> cb, policies const &p = policies());
+
 	Tcl_Interp *interp_;
 	bool owner_;
 };
@@ -499,13 +889,7 @@ template <class InputIterator> details::result interpreter::eval(InputIterator f
 
 }
 
-// additional callback envelopes for variadic functions
-#include "cpptcl/details/callbacks_v.h"
-
-// additional method envelopes for variadic methods
-#include "cpptcl/details/methods_v.h"
-
-
+// functors for calling Tcl commands from C++
 #include "cpptcl/details/bind.h"
 
 namespace Tcl {
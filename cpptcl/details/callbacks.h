@@ -15,206 +15,165 @@
 
 namespace Tcl { namespace details {
 
-template <typename R> class callback0 : public callback_base {
-	typedef R (*functor_type)();
+// converts the arguments to the values of the given parameter types
+// - the values are kept in a tuple until the call
+// - the conversion stops at the first bad argument, which leaves
+//   the error message in the interpreter
+template <typename... Ts> struct arguments {
+	typedef std::tuple<cast_value<Ts>...> values_type;
 
-  public:
-	callback0(functor_type f) : f_(f) {}
-
-	virtual void invoke(Tcl_Interp *interp, int, Tcl_Obj *CONST[], policies const &pol) { dispatch<R>::do_dispatch(interp, f_); }
+	static bool const nothrow = std::is_nothrow_default_constructible<values_type>::value && (noexcept(tcl_cast<Ts>::convert(std::declval<Tcl_Interp *>(), std::declval<Tcl_Obj *>(), std::declval<cast_value<Ts> &>())) && ...);
 
-  private:
-	functor_type f_;
+	template <std::size_t... Is> static bool convert([[maybe_unused]] Tcl_Interp *interp, [[maybe_unused]] Tcl_Obj *CONST objv[], [[maybe_unused]] values_type &values, std::index_sequence<Is...>) noexcept(nothrow) {
+		return ((tcl_cast<Ts>::convert(interp, objv[Is], std::get<Is>(values)) == TCL_OK) && ...);
+	}
 };
 
-template <typename R, typename T1> class callback1 : public callback_base {
-	typedef R (*functor_type)(T1);
-
-  public:
-	callback1(functor_type f) : f_(f) {}
-
-	virtual void invoke(Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[], policies const &pol) {
-		check_params_no(objc, 2, pol.usage_);
-		tcl_cast_by_reference<T1> byRef1;
-		dispatch<R>::template do_dispatch<T1>(interp, f_, tcl_cast<T1>::from(interp, objv[1], byRef1.value));
+// the invoker converts the Tcl arguments to the parameter types
+// and calls the functor with them
+// - Offset is the index of the first argument in objv
+//   (1 for free functions, 2 for class methods)
+// - the prefix arguments are passed before the converted ones
+//   (this is the object pointer for class methods)
+// - bad arguments are reported by returning TCL_ERROR,
+//   only the functor itself can throw
+template <int Offset, typename R, typename... Ts> struct invoker {
+	template <class Functor, typename... Prefix> static int invoke(Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[], policies const &pol, Functor &f, Prefix &&... prefix) {
+		return call(has_var_params<Ts...>(), std::make_index_sequence<sizeof...(Ts) - has_var_params<Ts...>::value>(), interp, objc, objv, pol, f, std::forward<Prefix>(prefix)...);
 	}
 
   private:
-	functor_type f_;
-};
-
-template <typename R, typename T1, typename T2> class callback2 : public callback_base {
-	typedef R (*functor_type)(T1, T2);
+	template <std::size_t I> using param_type = typename std::tuple_element<I, std::tuple<Ts...>>::type;
 
-  public:
-	callback2(functor_type f) : f_(f) {}
+	// all parameters are converted from single arguments
+	template <class Functor, std::size_t... Is, typename... Prefix> static int call(std::false_type, std::index_sequence<Is...>, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[], policies const &pol, Functor &f, Prefix &&... prefix) {
+		if (objc < Offset + static_cast<int>(sizeof...(Ts))) {
+			return params_no_error(interp, pol.usage_);
+		}
 
-	virtual void invoke(Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[], policies const &pol) {
-		check_params_no(objc, 3, pol.usage_);
-		tcl_cast_by_reference<T1> byRef1;
-		tcl_cast_by_reference<T2> byRef2;
+		typename arguments<Ts...>::values_type values;
+		if (!arguments<Ts...>::convert(interp, objv + Offset, values, std::index_sequence<Is...>())) {
+			return TCL_ERROR;
+		}
 
-		dispatch<R>::template do_dispatch<T1, T2>(interp, f_, tcl_cast<T1>::from(interp, objv[1], byRef1.value), tcl_cast<T2>::from(interp, objv[2], byRef2.value));
+		dispatch<R>::do_dispatch(interp, f, std::forward<Prefix>(prefix)..., std::get<Is>(std::move(values))...);
+		return TCL_OK;
 	}
 
-  private:
-	functor_type f_;
+	// the last parameter gathers the remaining arguments
+	template <class Functor, std::size_t... Is, typename... Prefix> static int call(std::true_type, std::index_sequence<Is...>, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[], policies const &pol, Functor &f, Prefix &&... prefix) {
+		int from = Offset + static_cast<int>(sizeof...(Is));
+		if (objc < (pol.variadic_ ? from : from + 1)) {
+			return params_no_error(interp, pol.usage_);
+		}
+
+		typename arguments<param_type<Is>...>::values_type values;
+		if (!arguments<param_type<Is>...>::convert(interp, objv + Offset, values, std::index_sequence<Is...>())) {
+			return TCL_ERROR;
+		}
+
+		object rest = get_var_params(interp, objc, objv, from, pol);
+		dispatch<R>::do_dispatch(interp, f, std::forward<Prefix>(prefix)..., std::get<Is>(std::move(values))..., rest);
+		return TCL_OK;
+	}
 };
 
-template <typename R, typename T1, typename T2, typename T3> class callback3 : public callback_base {
-	typedef R (*functor_type)(T1, T2, T3);
+template <typename R, typename... Ts> class callback : public callback_base {
+	typedef R (*functor_type)(Ts...);
 
   public:
-	callback3(functor_type f) : f_(f) {}
-
-	virtual void invoke(Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[], policies const &pol) {
-		check_params_no(objc, 4, pol.usage_);
-		tcl_cast_by_reference<T1> byRef1;
-		tcl_cast_by_reference<T2> byRef2;
-		tcl_cast_by_reference<T3> byRef3;
+	callback(functor_type f) : f_(f) {}
 
-		dispatch<R>::template do_dispatch<T1, T2, T3>(interp, f_, tcl_cast<T1>::from(interp, objv[1], byRef1.value), tcl_cast<T2>::from(interp, objv[2], byRef2.value), tcl_cast<T3>::from(interp, objv[3], byRef3.value));
-	}
+	virtual int invoke(Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[], policies const &pol) { return invoker<1, R, Ts...>::invoke(interp, objc, objv, pol, f_); }
 
   private:
 	functor_type f_;
 };
 
-template <typename R, typename T1, typename T2, typename T3, typename T4> class callback4 : public callback_base {
-	typedef R (*functor_type)(T1, T2, T3, T4);
+// callback for lambdas, std::function and other function objects
+// - the function object (with its captured state) is stored by value,
+//   inside the callback, and not in a separate allocation
+template <class F, typename Sig = functor_signature<F>> class functor_callback;
 
+template <class F, typename R, typename... Ts> class functor_callback<F, R(Ts...)> : public callback_base {
   public:
-	callback4(functor_type f) : f_(f) {}
+	template <class G> explicit functor_callback(G &&f) : f_(std::forward<G>(f)) {}
 
-	virtual void invoke(Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[], policies const &pol) {
-		check_params_no(objc, 5, pol.usage_);
-		tcl_cast_by_reference<T1> byRef1;
-		tcl_cast_by_reference<T2> byRef2;
-		tcl_cast_by_reference<T3> byRef3;
-		tcl_cast_by_reference<T4> byRef4;
-
-		dispatch<R>::template do_dispatch<T1, T2, T3, T4>(interp, f_, tcl_cast<T1>::from(interp, objv[1], byRef1.value), tcl_cast<T2>::from(interp, objv[2], byRef2.value), tcl_cast<T3>::from(interp, objv[3], byRef3.value), tcl_cast<T4>::from(interp, objv[4], byRef4.value));
-	}
+	virtual int invoke(Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[], policies const &pol) { return invoker<1, R, Ts...>::invoke(interp, objc, objv, pol, f_); }
 
   private:
-	functor_type f_;
+	F f_;
 };
 
-template <typename R, typename T1, typename T2, typename T3, typename T4, typename T5> class callback5 : public callback_base {
-	typedef R (*functor_type)(T1, T2, T3, T4, T5);
-
+// continuation of a tail evaluation, given the result of the script
+template <class F> class continuation : public continuation_base {
   public:
-	callback5(functor_type f) : f_(f) {}
-	tcl_cast_by_reference<T1> byRef1;
-	tcl_cast_by_reference<T2> byRef2;
-	tcl_cast_by_reference<T3> byRef3;
-	tcl_cast_by_reference<T4> byRef4;
-	tcl_cast_by_reference<T5> byRef5;
-
-	virtual void invoke(Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[], policies const &pol) {
-		check_params_no(objc, 6, pol.usage_);
+	template <class G> explicit continuation(G &&f) : f_(std::forward<G>(f)) {}
 
-		dispatch<R>::template do_dispatch<T1, T2, T3, T4, T5>(interp, f_, tcl_cast<T1>::from(interp, objv[1], byRef1.value), tcl_cast<T2>::from(interp, objv[2], byRef2.value), tcl_cast<T3>::from(interp, objv[3], byRef3.value), tcl_cast<T4>::from(interp, objv[4], byRef4.value), tcl_cast<T5>::from(interp, objv[5], byRef5.value));
-	}
+	virtual void invoke(Tcl_Interp *interp, object const &result) { dispatch<std::invoke_result_t<F &, object const &>>::do_dispatch(interp, f_, result); }
 
   private:
-	functor_type f_;
+	F f_;
 };
 
-template <typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6> class callback6 : public callback_base {
-	typedef R (*functor_type)(T1, T2, T3, T4, T5, T6);
-
-  public:
-	callback6(functor_type f) : f_(f) {}
-
-	virtual void invoke(Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[], policies const &pol) {
-		check_params_no(objc, 7, pol.usage_);
-		tcl_cast_by_reference<T1> byRef1;
-		tcl_cast_by_reference<T2> byRef2;
-		tcl_cast_by_reference<T3> byRef3;
-		tcl_cast_by_reference<T4> byRef4;
-		tcl_cast_by_reference<T5> byRef5;
-		tcl_cast_by_reference<T6> byRef6;
-
-		dispatch<R>::template do_dispatch<T1, T2, T3, T4, T5, T6>(interp, f_, tcl_cast<T1>::from(interp, objv[1], byRef1.value), tcl_cast<T2>::from(interp, objv[2], byRef2.value), tcl_cast<T3>::from(interp, objv[3], byRef3.value), tcl_cast<T4>::from(interp, objv[4], byRef4.value), tcl_cast<T5>::from(interp, objv[5], byRef5.value), tcl_cast<T6>::from(interp, objv[6], byRef6.value));
-	}
+// the trampoline is a dedicated command procedure generated for
+// a single free function that is known at compile time
+// - there is no callback object and no policies to consult,
+//   the function is called directly from the command procedure
+// - when neither the function nor the conversions of its arguments
+//   and result can throw, no exception handling code is generated
 
-  private:
-	functor_type f_;
+template <typename R> struct result_nothrow {
+	static bool const value = noexcept(set_result(std::declval<Tcl_Interp *>(), std::declval<R>()));
 };
 
-template <typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7> class callback7 : public callback_base {
-	typedef R (*functor_type)(T1, T2, T3, T4, T5, T6, T7);
-
-  public:
-	callback7(functor_type f) : f_(f) {}
-
-	virtual void invoke(Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[], policies const &pol) {
-		check_params_no(objc, 8, pol.usage_);
-		tcl_cast_by_reference<T1> byRef1;
-		tcl_cast_by_reference<T2> byRef2;
-		tcl_cast_by_reference<T3> byRef3;
-		tcl_cast_by_reference<T4> byRef4;
-		tcl_cast_by_reference<T5> byRef5;
-		tcl_cast_by_reference<T6> byRef6;
-		tcl_cast_by_reference<T7> byRef7;
-
-		dispatch<R>::template do_dispatch<T1, T2, T3, T4, T5, T6, T7>(interp, f_, tcl_cast<T1>::from(interp, objv[1], byRef1.value), tcl_cast<T2>::from(interp, objv[2], byRef2.value), tcl_cast<T3>::from(interp, objv[3], byRef3.value), tcl_cast<T4>::from(interp, objv[4], byRef4.value), tcl_cast<T5>::from(interp, objv[5], byRef5.value), tcl_cast<T6>::from(interp, objv[6], byRef6.value), tcl_cast<T7>::from(interp, objv[7], byRef7.value));
-	}
-
-  private:
-	functor_type f_;
+template <> struct result_nothrow<void> {
+	static bool const value = true;
 };
 
-template <typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7, typename T8> class callback8 : public callback_base {
-	typedef R (*functor_type)(T1, T2, T3, T4, T5, T6, T7, T8);
-
-  public:
-	callback8(functor_type f) : f_(f) {}
-
-	virtual void invoke(Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[], policies const &pol) {
-		check_params_no(objc, 9, pol.usage_);
-		tcl_cast_by_reference<T1> byRef1;
-		tcl_cast_by_reference<T2> byRef2;
-		tcl_cast_by_reference<T3> byRef3;
-		tcl_cast_by_reference<T4> byRef4;
-		tcl_cast_by_reference<T5> byRef5;
-		tcl_cast_by_reference<T6> byRef6;
-		tcl_cast_by_reference<T7> byRef7;
-		tcl_cast_by_reference<T8> byRef8;
-
-		dispatch<R>::template do_dispatch<T1, T2, T3, T4, T5, T6, T7, T8>(interp, f_, tcl_cast<T1>::from(interp, objv[1], byRef1.value), tcl_cast<T2>::from(interp, objv[2], byRef2.value), tcl_cast<T3>::from(interp, objv[3], byRef3.value), tcl_cast<T4>::from(interp, objv[4], byRef4.value), tcl_cast<T5>::from(interp, objv[5], byRef5.value), tcl_cast<T6>::from(interp, objv[6], byRef6.value), tcl_cast<T7>::from(interp, objv[7], byRef7.value), tcl_cast<T8>::from(interp, objv[8], byRef8.value));
+template <auto F, typename R, typename... Ts> struct trampoline_proc {
+	typedef arguments<Ts...> args_type;
+
+	static bool const nothrow = args_type::nothrow && noexcept(F(std::declval<cast_value<Ts>>()...)) && result_nothrow<R>::value;
+
+	static int command(ClientData, Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[]) {
+		if (objc < 1 + static_cast<int>(sizeof...(Ts))) {
+			Tcl_SetObjResult(interp, Tcl_NewStringObj("Too few arguments.", -1));
+			return TCL_ERROR;
+		}
+
+		if constexpr (nothrow) {
+			return call(interp, objv, std::index_sequence_for<Ts...>());
+		} else {
+			try {
+				return call(interp, objv, std::index_sequence_for<Ts...>());
+			} catch (std::exception const &e) {
+				Tcl_SetObjResult(interp, Tcl_NewStringObj(e.what(), -1));
+				return TCL_ERROR;
+			} catch (...) {
+				Tcl_SetObjResult(interp, Tcl_NewStringObj("Unknown error.", -1));
+				return TCL_ERROR;
+			}
+		}
 	}
 
   private:
-	functor_type f_;
+	template <std::size_t... Is> static int call(Tcl_Interp *interp, Tcl_Obj *CONST objv[], std::index_sequence<Is...>) noexcept(nothrow) {
+		typename args_type::values_type values;
+		if (!args_type::convert(interp, objv + 1, values, std::index_sequence<Is...>())) {
+			return TCL_ERROR;
+		}
+
+		dispatch<R>::do_dispatch(interp, F, std::get<Is>(std::move(values))...);
+		return TCL_OK;
+	}
 };
 
-template <typename R, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7, typename T8, typename T9> class callback9 : public callback_base {
-	typedef R (*functor_type)(T1, T2, T3, T4, T5, T6, T7, T8, T9);
+template <auto F, typename Functor = decltype(F)> struct trampoline;
 
-  public:
-	callback9(functor_type f) : f_(f) {}
-
-	virtual void invoke(Tcl_Interp *interp, int objc, Tcl_Obj *CONST objv[], policies const &pol) {
-		check_params_no(objc, 10, pol.usage_);
-		tcl_cast_by_reference<T1> byRef1;
-		tcl_cast_by_reference<T2> byRef2;
-		tcl_cast_by_reference<T3> byRef3;
-		tcl_cast_by_reference<T4> byRef4;
-		tcl_cast_by_reference<T5> byRef5;
-		tcl_cast_by_reference<T6> byRef6;
-		tcl_cast_by_reference<T7> byRef7;
-		tcl_cast_by_reference<T8> byRef8;
-		tcl_cast_by_reference<T9> byRef9;
-
-		dispatch<R>::template do_dispatch<T1, T2, T3, T4, T5, T6, T7, T8, T9>(interp, f_, tcl_cast<T1>::from(interp, objv[1], byRef1.value), tcl_cast<T2>::from(interp, objv[2], byRef2.value), tcl_cast<T3>::from(interp, objv[3], byRef3.value), tcl_cast<T4>::from(interp, objv[4], byRef4.value), tcl_cast<T5>::from(interp, objv[5], byRef5.value), tcl_cast<T6>::from(interp, objv[6], byRef6.value), tcl_cast<T7>::from(interp, objv[7], byRef7.value), tcl_cast<T8>::from(interp, objv[8], byRef8.value),
-																			  tcl_cast<T9>::from(interp, objv[9], byRef9.value));
-	}
+template <auto F, typename R, typename... Ts> struct trampoline<F, R (*)(Ts...)> : trampoline_proc<F, R, Ts...> {};
 
-  private:
-	functor_type f_;
-};
+template <auto F, typename R, typename... Ts> struct trampoline<F, R (*)(Ts...) noexcept> : trampoline_proc<F, R, Ts...> {};
 
 }
 
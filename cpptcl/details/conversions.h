@@ -13,27 +13,207 @@
 // helper functor for converting Tcl objects to the given type
 // (it is a struct instead of function,
 // because I need to partially specialize it)
+// - from() throws tcl_error when the object cannot be converted
+// - convert() stores the value in its last parameter and returns
+//   TCL_OK or TCL_ERROR, with the error message in the interpreter;
+//   this is what the command handlers use, so that bad arguments
+//   do not cost an exception
 namespace Tcl { namespace details {
 
 template <typename T> struct tcl_cast;
 
-template <typename T> struct tcl_cast<T *> {
-	static T *from(Tcl_Interp *, Tcl_Obj *obj, bool byReference) {
-		std::string s(Tcl_GetString(obj));
-		if (s.size() == 0) {
-			throw tcl_error("Expected pointer value, got empty string.");
+// types with the value_type specialization
+template <typename T, typename = void> struct is_value_type : std::false_type {};
+template <typename T> struct is_value_type<T, std::void_t<decltype(value_type<T>::name)>> : std::true_type {};
+
+// the Tcl_ObjType of the value type T
+template <typename T> struct value_obj_type {
+	typedef decltype(std::declval<Tcl_Obj &>().internalRep) rep_type;
+
+	static bool const in_place = sizeof(T) <= sizeof(rep_type) && alignof(T) <= alignof(rep_type) && std::is_trivially_copyable<T>::value;
+
+	static T *get(Tcl_Obj *obj) {
+		if constexpr (in_place) {
+			return reinterpret_cast<T *>(&obj->internalRep);
+		} else {
+			return static_cast<T *>(obj->internalRep.twoPtrValue.ptr1);
 		}
+	}
 
-		if (s[0] != 'p') {
-			throw tcl_error("Expected pointer value.");
+	// the object must not have an internal rep
+	static void set(Tcl_Obj *obj, T const &v) {
+		if constexpr (in_place) {
+			new (&obj->internalRep) T(v);
+		} else {
+			obj->internalRep.twoPtrValue.ptr1 = new T(v);
 		}
+		obj->typePtr = &type;
+	}
 
-		std::istringstream ss(s);
-		char dummy;
-		void *p;
-		ss >> dummy >> p;
+	static void free_intrep_proc(Tcl_Obj *obj) { delete get(obj); }
+
+	static void dup_intrep_proc(Tcl_Obj *src, Tcl_Obj *dup) { set(dup, *get(src)); }
+
+	static void update_string_proc(Tcl_Obj *obj) {
+		std::string s = value_type<T>::format(*get(obj));
+		obj->bytes = static_cast<char *>(Tcl_Alloc(static_cast<int>(s.size() + 1)));
+		s.copy(obj->bytes, s.size());
+		obj->bytes[s.size()] = '\0';
+		obj->length = static_cast<Tcl_Size>(s.size());
+	}
+
+	static int set_from_any_proc(Tcl_Interp *interp, Tcl_Obj *obj);
+
+	static Tcl_ObjType type;
+};
+
+template <typename T>
+Tcl_ObjType value_obj_type<T>::type = {
+	const_cast<char *>(value_type<T>::name),			 // name
+	in_place ? 0 : &value_obj_type<T>::free_intrep_proc, // freeIntRepProc
+	&value_obj_type<T>::dup_intrep_proc,				 // dupIntRepProc
+	&value_obj_type<T>::update_string_proc,			 // updateStringProc
+	&value_obj_type<T>::set_from_any_proc				 // setFromAnyProc
+};
+
+// the value is parsed from the string only when the object
+// does not hold it already
+template <typename T> struct tcl_cast_value {
+	static_assert(is_value_type<T>::value, "no conversion for this type (see Tcl::value_type)");
+
+	static T from(Tcl_Interp *interp, Tcl_Obj *obj, bool = false) {
+		T res;
+		if (convert(interp, obj, res) != TCL_OK) {
+			throw tcl_error(interp);
+		}
+
+		return res;
+	}
+
+	static int convert(Tcl_Interp *interp, Tcl_Obj *obj, T &res) {
+		if (obj->typePtr != &value_obj_type<T>::type && value_obj_type<T>::set_from_any_proc(interp, obj) != TCL_OK) {
+			return TCL_ERROR;
+		}
+
+		res = *value_obj_type<T>::get(obj);
+		return TCL_OK;
+	}
+};
+
+template <typename T> int value_obj_type<T>::set_from_any_proc(Tcl_Interp *interp, Tcl_Obj *obj) {
+	// the string is all that remains of the old internal rep
+	Tcl_GetString(obj);
+
+	T v;
+	if (value_type<T>::parse(interp, obj, v) != TCL_OK) {
+		return TCL_ERROR;
+	}
+
+	if (obj->typePtr != 0 && obj->typePtr->freeIntRepProc != 0) {
+		obj->typePtr->freeIntRepProc(obj);
+	}
+	set(obj, v);
+
+	return TCL_OK;
+}
+
+// types with the enum_type specialization
+template <typename E, typename = void> struct is_enum_type : std::false_type {};
+template <typename E> struct is_enum_type<E, std::void_t<decltype(enum_type<E>::values)>> : std::true_type {};
 
-		return static_cast<T *>(p);
+// the names of the enum type E
+template <typename E> struct enum_table {
+	static constexpr std::size_t size = std::size(enum_type<E>::values);
+
+	// with the terminating entry for Tcl_GetIndexFromObjStruct
+	static std::array<enum_value<E>, size + 1> const entries;
+
+	// the index of the value, or size when it has no name
+	static std::size_t find(E v) {
+		std::size_t i = 0;
+		while (i != size && entries[i].value != v) {
+			++i;
+		}
+		return i;
+	}
+
+	// the result object of the name with index i
+	// - the same objects are given for scalar results and for the
+	//   elements of lists, tuples and structs
+	// - Tcl objects cannot be shared between threads, so each thread
+	//   has its own, released when Tcl finalizes the thread
+	static Tcl_Obj *name(std::size_t i) {
+		if (names_ == 0) {
+			names_ = new std::array<Tcl_Obj *, size>;
+			for (std::size_t k = 0; k != size; ++k) {
+				(*names_)[k] = Tcl_NewStringObj(entries[k].name, -1);
+				Tcl_IncrRefCount((*names_)[k]);
+			}
+			Tcl_CreateThreadExitHandler(release_names, 0);
+		}
+		return (*names_)[i];
+	}
+
+	static void release_names(ClientData) {
+		for (Tcl_Obj *n : *names_) {
+			Tcl_DecrRefCount(n);
+		}
+		delete names_;
+		names_ = 0;
+	}
+
+	template <std::size_t... Is> static std::array<enum_value<E>, size + 1> make_entries(std::index_sequence<Is...>) { return {{enum_type<E>::values[Is]..., {0, E()}}}; }
+
+	static thread_local std::array<Tcl_Obj *, size> *names_;
+};
+
+template <typename E> std::array<enum_value<E>, enum_table<E>::size + 1> const enum_table<E>::entries = enum_table<E>::make_entries(std::make_index_sequence<enum_table<E>::size>());
+
+template <typename E> thread_local std::array<Tcl_Obj *, enum_table<E>::size> *enum_table<E>::names_ = 0;
+
+template <typename E> struct tcl_cast_enum {
+	static E from(Tcl_Interp *interp, Tcl_Obj *obj, bool = false) {
+		E res;
+		if (convert(interp, obj, res) != TCL_OK) {
+			throw tcl_error(interp);
+		}
+
+		return res;
+	}
+
+	static int convert(Tcl_Interp *interp, Tcl_Obj *obj, E &res) noexcept {
+		int i;
+		if (Tcl_GetIndexFromObjStruct(interp, obj, enum_table<E>::entries.data(), sizeof(enum_value<E>), enum_type<E>::name, TCL_EXACT, &i) != TCL_OK) {
+			return TCL_ERROR;
+		}
+
+		res = enum_table<E>::entries[i].value;
+		return TCL_OK;
+	}
+};
+
+// types with the struct_type specialization
+// (the conversions are at the end of this file)
+template <typename S, typename = void> struct is_struct_type : std::false_type {};
+template <typename S> struct is_struct_type<S, std::void_t<decltype(&struct_type<S>::describe)>> : std::true_type {};
+
+template <typename S> struct tcl_cast_struct;
+
+// the types without other conversions
+template <typename T> struct tcl_cast : std::conditional_t<is_enum_type<T>::value, tcl_cast_enum<T>, std::conditional_t<is_struct_type<T>::value, tcl_cast_struct<T>, tcl_cast_value<T>>> {};
+
+template <typename T> struct tcl_cast<T *> {
+	static T *from(Tcl_Interp *, Tcl_Obj *obj, bool byReference) {
+		typedef typename std::remove_cv<T>::type U;
+		return static_cast<T *>(get_pointer_handle(obj, type_tag<U>::get()));
+	}
+
+	static int convert(Tcl_Interp *interp, Tcl_Obj *obj, T *&res) noexcept {
+		typedef typename std::remove_cv<T>::type U;
+		void *p;
+		int cc = get_pointer_handle(interp, obj, type_tag<U>::get(), p);
+		res = static_cast<T *>(p);
+		return cc;
 	}
 };
 
@@ -43,8 +223,13 @@ template <typename T> struct tcl_cast<T *> {
 
 template <typename T> struct tcl_cast<T const &> {
 	static T from(Tcl_Interp *interp, Tcl_Obj *obj, bool byReference) { return tcl_cast<T>::from(interp, obj, byReference); }
+
+	static int convert(Tcl_Interp *interp, Tcl_Obj *obj, T &res) noexcept(noexcept(tcl_cast<T>::convert(interp, obj, res))) { return tcl_cast<T>::convert(interp, obj, res); }
 };
 
+// type of the value that holds the converted argument until the call
+template <typename T> using cast_value = typename std::remove_cv<typename std::remove_reference<T>::type>::type;
+
 template <typename T> class tcl_cast_by_reference {
   public:
 	static bool const value = false;
@@ -52,19 +237,582 @@ template <typename T> class tcl_cast_by_reference {
 
 // the following specializations are implemented
 
-template <> struct tcl_cast<int> { static int from(Tcl_Interp *, Tcl_Obj *, bool byReference = false); };
+template <> struct tcl_cast<int> {
+	static int from(Tcl_Interp *, Tcl_Obj *, bool byReference = false);
+	static int convert(Tcl_Interp *, Tcl_Obj *, int &res) noexcept;
+};
+
+template <> struct tcl_cast<long> {
+	static long from(Tcl_Interp *, Tcl_Obj *, bool byReference = false);
+	static int convert(Tcl_Interp *, Tcl_Obj *, long &res) noexcept;
+};
+
+// the other integer types, with range checks
+// - values out of the range of the type are rejected,
+//   like the values out of the range of Tcl_WideInt
+int get_wide_int(Tcl_Interp *interp, Tcl_Obj *obj, Tcl_WideInt &res) noexcept;
+int get_unsigned_wide_int(Tcl_Interp *interp, Tcl_Obj *obj, Tcl_WideUInt &res) noexcept;
+int integer_range_error(Tcl_Interp *interp) noexcept;
+
+template <typename T> struct tcl_cast_integer {
+	static T from(Tcl_Interp *interp, Tcl_Obj *obj, bool = false) {
+		T res;
+		if (convert(interp, obj, res) != TCL_OK) {
+			throw tcl_error(interp);
+		}
+
+		return res;
+	}
+
+	static int convert(Tcl_Interp *interp, Tcl_Obj *obj, T &res) noexcept {
+		if constexpr (std::is_signed<T>::value) {
+			Tcl_WideInt w;
+			if (get_wide_int(interp, obj, w) != TCL_OK) {
+				return TCL_ERROR;
+			}
+			if (w < std::numeric_limits<T>::min() || w > std::numeric_limits<T>::max()) {
+				return integer_range_error(interp);
+			}
+
+			res = static_cast<T>(w);
+		} else {
+			Tcl_WideUInt w;
+			if (get_unsigned_wide_int(interp, obj, w) != TCL_OK) {
+				return TCL_ERROR;
+			}
+			if (w > std::numeric_limits<T>::max()) {
+				return integer_range_error(interp);
+			}
+
+			res = static_cast<T>(w);
+		}
+
+		return TCL_OK;
+	}
+};
+
+template <> struct tcl_cast<signed char> : tcl_cast_integer<signed char> {};
+template <> struct tcl_cast<unsigned char> : tcl_cast_integer<unsigned char> {};
+template <> struct tcl_cast<short> : tcl_cast_integer<short> {};
+template <> struct tcl_cast<unsigned short> : tcl_cast_integer<unsigned short> {};
+template <> struct tcl_cast<unsigned int> : tcl_cast_integer<unsigned int> {};
+template <> struct tcl_cast<unsigned long> : tcl_cast_integer<unsigned long> {};
+template <> struct tcl_cast<long long> : tcl_cast_integer<long long> {};
+template <> struct tcl_cast<unsigned long long> : tcl_cast_integer<unsigned long long> {};
 
-template <> struct tcl_cast<long> { static long from(Tcl_Interp *, Tcl_Obj *, bool byReference = false); };
+template <> struct tcl_cast<bool> {
+	static bool from(Tcl_Interp *, Tcl_Obj *, bool byReference = false);
+	static int convert(Tcl_Interp *, Tcl_Obj *, bool &res) noexcept;
+};
 
-template <> struct tcl_cast<bool> { static bool from(Tcl_Interp *, Tcl_Obj *, bool byReference = false); };
+template <> struct tcl_cast<double> {
+	static double from(Tcl_Interp *, Tcl_Obj *, bool byReference = false);
+	static int convert(Tcl_Interp *, Tcl_Obj *, double &res) noexcept;
+};
 
-template <> struct tcl_cast<double> { static double from(Tcl_Interp *, Tcl_Obj *, bool byReference = false); };
+// values beyond the range of float are rejected
+template <> struct tcl_cast<float> {
+	static float from(Tcl_Interp *, Tcl_Obj *, bool byReference = false);
+	static int convert(Tcl_Interp *, Tcl_Obj *, float &res) noexcept;
+};
 
-template <> struct tcl_cast<std::string> { static std::string from(Tcl_Interp *, Tcl_Obj *, bool byReference = false); };
+template <> struct tcl_cast<std::string> {
+	static std::string from(Tcl_Interp *, Tcl_Obj *, bool byReference = false);
+	static int convert(Tcl_Interp *, Tcl_Obj *, std::string &res);
+};
+
+// the view refers to the string of the Tcl object,
+// which is valid for the duration of the call
+template <> struct tcl_cast<std::string_view> {
+	static std::string_view from(Tcl_Interp *, Tcl_Obj *, bool byReference = false);
+	static int convert(Tcl_Interp *, Tcl_Obj *, std::string_view &res) noexcept;
+};
+
+template <> struct tcl_cast<char const *> {
+	static char const *from(Tcl_Interp *, Tcl_Obj *, bool byReference = false);
+	static int convert(Tcl_Interp *, Tcl_Obj *, char const *&res) noexcept;
+};
 
-template <> struct tcl_cast<char const *> { static char const *from(Tcl_Interp *, Tcl_Obj *, bool byReference = false); };
+template <> struct tcl_cast<object> {
+	static object from(Tcl_Interp *, Tcl_Obj *, bool byReference = false);
+	static int convert(Tcl_Interp *, Tcl_Obj *, object &res) noexcept;
+};
+
+// the bytes are not copied (see const_byte_span and byte_span)
+template <> struct tcl_cast<const_byte_span> {
+	static const_byte_span from(Tcl_Interp *, Tcl_Obj *, bool byReference = false);
+	static int convert(Tcl_Interp *, Tcl_Obj *, const_byte_span &res) noexcept;
+};
+
+template <> struct tcl_cast<byte_span> {
+	static byte_span from(Tcl_Interp *, Tcl_Obj *, bool byReference = false);
+	static int convert(Tcl_Interp *, Tcl_Obj *, byte_span &res) noexcept;
+};
+
+// value type results keep the value, with no string form yet
+
+template <typename T> typename std::enable_if<is_value_type<T>::value, Tcl_Obj *>::type make_obj(T const &v) {
+	Tcl_Obj *obj = Tcl_NewObj();
+	Tcl_InvalidateStringRep(obj);
+	value_obj_type<T>::set(obj, v);
+	return obj;
+}
+
+template <typename T> typename std::enable_if<is_value_type<T>::value>::type set_result(Tcl_Interp *interp, T const &v) { Tcl_SetObjResult(interp, make_obj(v)); }
+
+// enum results are the names
+
+template <typename E> typename std::enable_if<is_enum_type<E>::value, Tcl_Obj *>::type make_obj(E v) noexcept {
+	std::size_t i = enum_table<E>::find(v);
+	if (i == enum_table<E>::size) {
+		return make_obj(static_cast<long long>(v));
+	}
+
+	return enum_table<E>::name(i);
+}
+
+template <typename E> typename std::enable_if<is_enum_type<E>::value>::type set_result(Tcl_Interp *interp, E v) noexcept {
+	std::size_t i = enum_table<E>::find(v);
+	if (i == enum_table<E>::size) {
+		set_result(interp, static_cast<long long>(v));
+	} else {
+		Tcl_SetObjResult(interp, enum_table<E>::name(i));
+	}
+}
+
+// packed arrays (implemented for double, float, int32_t and int64_t)
+
+template <typename T> struct tcl_cast<packed_array<T>> {
+	static packed_array<T> from(Tcl_Interp *interp, Tcl_Obj *obj, bool = false);
+	static int convert(Tcl_Interp *interp, Tcl_Obj *obj, packed_array<T> &res) noexcept;
+};
+
+template <typename T> Tcl_Obj *make_obj(packed_array<T> const &a) noexcept;
+
+template <typename T> void set_result(Tcl_Interp *interp, packed_array<T> const &a) noexcept { Tcl_SetObjResult(interp, make_obj(a)); }
+
+// lists of numbers given as plain strings (like lines read from
+// a socket) are parsed in one pass over the string, without making
+// the list and the element objects
+// - parse_number_list() returns false when the string has anything
+//   but numbers separated by white space, or numbers that Tcl reads
+//   in its own way (like 017, 0x1f or 1e999), and the list is then
+//   converted in the usual way
+// - implemented for double, int, long and long long
+template <typename T> struct is_bulk_number {
+	static bool const value = std::is_same<T, double>::value || std::is_same<T, int>::value || std::is_same<T, long>::value || std::is_same<T, long long>::value;
+};
+
+template <typename T> bool parse_number_list(Tcl_Obj *obj, std::vector<T> &res);
+
+template <typename S> typename std::enable_if<is_struct_type<S>::value, Tcl_Obj *>::type make_obj(S const &s);
+
+template <typename S> typename std::enable_if<is_struct_type<S>::value>::type set_result(Tcl_Interp *interp, S const &s) { Tcl_SetObjResult(interp, make_obj(s)); }
+
+// lists, converted in one pass over the elements
+
+template <typename T> struct tcl_cast<std::vector<T>> {
+	static std::vector<T> from(Tcl_Interp *interp, Tcl_Obj *obj, bool = false) {
+		std::vector<T> res;
+		if (convert(interp, obj, res) != TCL_OK) {
+			throw tcl_error(interp);
+		}
+
+		return res;
+	}
+
+	static int convert(Tcl_Interp *interp, Tcl_Obj *obj, std::vector<T> &res) {
+		if constexpr (is_bulk_number<T>::value) {
+			if (parse_number_list(obj, res)) {
+				return TCL_OK;
+			}
+		}
+
+		Tcl_Size n;
+		Tcl_Obj **elems;
+		if (Tcl_ListObjGetElements(interp, obj, &n, &elems) != TCL_OK) {
+			return TCL_ERROR;
+		}
+
+		res.clear();
+		res.reserve(n);
+		for (Tcl_Size i = 0; i != n; ++i) {
+			cast_value<T> v;
+			if (tcl_cast<T>::convert(interp, elems[i], v) != TCL_OK) {
+				return TCL_ERROR;
+			}
+			res.push_back(std::move(v));
+		}
+
+		return TCL_OK;
+	}
+};
 
-template <> struct tcl_cast<object> { static object from(Tcl_Interp *, Tcl_Obj *, bool byReference = false); };
+// the list must have exactly N elements
+template <typename T, std::size_t N> struct tcl_cast<std::array<T, N>> {
+	static std::array<T, N> from(Tcl_Interp *interp, Tcl_Obj *obj, bool = false) {
+		std::array<T, N> res;
+		if (convert(interp, obj, res) != TCL_OK) {
+			throw tcl_error(interp);
+		}
+
+		return res;
+	}
+
+	static int convert(Tcl_Interp *interp, Tcl_Obj *obj, std::array<T, N> &res) noexcept(noexcept(tcl_cast<T>::convert(interp, obj, res[0]))) {
+		Tcl_Size n;
+		Tcl_Obj **elems;
+		if (Tcl_ListObjGetElements(interp, obj, &n, &elems) != TCL_OK) {
+			return TCL_ERROR;
+		}
+
+		if (n != static_cast<Tcl_Size>(N)) {
+			if (interp != 0) {
+				Tcl_SetObjResult(interp, Tcl_ObjPrintf("expected list of %d elements but got %d", static_cast<int>(N), static_cast<int>(n)));
+			}
+			return TCL_ERROR;
+		}
+
+		for (std::size_t i = 0; i != N; ++i) {
+			if (tcl_cast<T>::convert(interp, elems[i], res[i]) != TCL_OK) {
+				return TCL_ERROR;
+			}
+		}
+
+		return TCL_OK;
+	}
+};
+
+// std::tuple and std::pair are lists with exactly one element per member
+
+template <class Tup> struct tcl_cast_tuple {
+	static constexpr std::size_t N = std::tuple_size<Tup>::value;
+
+	static Tup from(Tcl_Interp *interp, Tcl_Obj *obj, bool = false) {
+		Tup res;
+		if (convert(interp, obj, res) != TCL_OK) {
+			throw tcl_error(interp);
+		}
+
+		return res;
+	}
+
+	static int convert(Tcl_Interp *interp, Tcl_Obj *obj, Tup &res) {
+		Tcl_Size n;
+		Tcl_Obj **elems;
+		if (Tcl_ListObjGetElements(interp, obj, &n, &elems) != TCL_OK) {
+			return TCL_ERROR;
+		}
+
+		if (n != static_cast<Tcl_Size>(N)) {
+			if (interp != 0) {
+				Tcl_SetObjResult(interp, Tcl_ObjPrintf("expected list of %d elements but got %d", static_cast<int>(N), static_cast<int>(n)));
+			}
+			return TCL_ERROR;
+		}
+
+		return convert_elements(interp, elems, res, std::make_index_sequence<N>());
+	}
+
+  private:
+	template <std::size_t... Is> static int convert_elements(Tcl_Interp *interp, Tcl_Obj **elems, Tup &res, std::index_sequence<Is...>) {
+		bool ok = (true && ... && (tcl_cast<std::tuple_element_t<Is, Tup>>::convert(interp, elems[Is], std::get<Is>(res)) == TCL_OK));
+		return ok ? TCL_OK : TCL_ERROR;
+	}
+};
+
+template <typename... Ts> struct tcl_cast<std::tuple<Ts...>> : tcl_cast_tuple<std::tuple<Ts...>> {};
+
+template <typename T1, typename T2> struct tcl_cast<std::pair<T1, T2>> : tcl_cast_tuple<std::pair<T1, T2>> {};
+
+// an empty argument means no value
+template <typename T> struct tcl_cast<std::optional<T>> {
+	static std::optional<T> from(Tcl_Interp *interp, Tcl_Obj *obj, bool = false) {
+		std::optional<T> res;
+		if (convert(interp, obj, res) != TCL_OK) {
+			throw tcl_error(interp);
+		}
+
+		return res;
+	}
+
+	static int convert(Tcl_Interp *interp, Tcl_Obj *obj, std::optional<T> &res) {
+		Tcl_Size len;
+		Tcl_GetStringFromObj(obj, &len);
+		if (len == 0) {
+			res.reset();
+			return TCL_OK;
+		}
+
+		cast_value<T> v;
+		if (tcl_cast<T>::convert(interp, obj, v) != TCL_OK) {
+			return TCL_ERROR;
+		}
+		res = std::move(v);
+
+		return TCL_OK;
+	}
+};
+
+// list results are built with a single Tcl_NewListObj
+
+template <typename T> Tcl_Obj *make_obj(std::vector<T> const &v);
+template <typename T, std::size_t N> Tcl_Obj *make_obj(std::array<T, N> const &a);
+template <typename K, typename V> Tcl_Obj *make_obj(std::map<K, V> const &m);
+template <typename K, typename V> Tcl_Obj *make_obj(std::unordered_map<K, V> const &m);
+template <typename... Ts> Tcl_Obj *make_obj(std::tuple<Ts...> const &t);
+template <typename T1, typename T2> Tcl_Obj *make_obj(std::pair<T1, T2> const &p);
+template <typename T> Tcl_Obj *make_obj(std::optional<T> const &o);
+
+template <class InputIterator> Tcl_Obj *make_list_obj(InputIterator first, InputIterator last, std::size_t n) {
+	std::vector<Tcl_Obj *> elems;
+	elems.reserve(n);
+	for (; first != last; ++first) {
+		elems.push_back(make_obj(*first));
+	}
+
+	return Tcl_NewListObj(static_cast<int>(elems.size()), elems.data());
+}
+
+template <typename T> Tcl_Obj *make_obj(std::vector<T> const &v) {
+	if constexpr (std::is_same<T, double>::value) {
+		return make_double_list_obj(v.data(), v.size());
+	} else {
+		return make_list_obj(v.begin(), v.end(), v.size());
+	}
+}
+
+template <typename T, std::size_t N> Tcl_Obj *make_obj(std::array<T, N> const &a) {
+	if constexpr (std::is_same<T, double>::value) {
+		return make_double_list_obj(a.data(), N);
+	} else {
+		return make_list_obj(a.begin(), a.end(), N);
+	}
+}
+
+template <class Tup, std::size_t... Is> Tcl_Obj *make_tuple_obj(Tup const &t, std::index_sequence<Is...>) {
+	std::array<Tcl_Obj *, sizeof...(Is)> elems = {{make_obj(std::get<Is>(t))...}};
+	return Tcl_NewListObj(static_cast<int>(elems.size()), elems.data());
+}
+
+template <typename... Ts> Tcl_Obj *make_obj(std::tuple<Ts...> const &t) { return make_tuple_obj(t, std::index_sequence_for<Ts...>()); }
+
+template <typename T1, typename T2> Tcl_Obj *make_obj(std::pair<T1, T2> const &p) { return make_tuple_obj(p, std::make_index_sequence<2>()); }
+
+// no value is an empty result
+template <typename T> Tcl_Obj *make_obj(std::optional<T> const &o) { return o ? make_obj(*o) : Tcl_NewObj(); }
+
+template <typename T> void set_result(Tcl_Interp *interp, std::vector<T> const &v) { Tcl_SetObjResult(interp, make_obj(v)); }
+
+template <typename T, std::size_t N> void set_result(Tcl_Interp *interp, std::array<T, N> const &a) { Tcl_SetObjResult(interp, make_obj(a)); }
+
+template <typename... Ts> void set_result(Tcl_Interp *interp, std::tuple<Ts...> const &t) { Tcl_SetObjResult(interp, make_obj(t)); }
+
+template <typename T1, typename T2> void set_result(Tcl_Interp *interp, std::pair<T1, T2> const &p) { Tcl_SetObjResult(interp, make_obj(p)); }
+
+template <typename T> void set_result(Tcl_Interp *interp, std::optional<T> const &o) { Tcl_SetObjResult(interp, make_obj(o)); }
+
+// dicts, converted in one pass over the entries
+
+template <class M> struct tcl_cast_dict {
+	typedef typename M::key_type K;
+	typedef typename M::mapped_type V;
+
+	static M from(Tcl_Interp *interp, Tcl_Obj *obj, bool = false) {
+		M res;
+		if (convert(interp, obj, res) != TCL_OK) {
+			throw tcl_error(interp);
+		}
+
+		return res;
+	}
+
+	static int convert(Tcl_Interp *interp, Tcl_Obj *obj, M &res) {
+		Tcl_DictSearch search;
+		Tcl_Obj *key;
+		Tcl_Obj *value;
+		int done;
+		if (Tcl_DictObjFirst(interp, obj, &search, &key, &value, &done) != TCL_OK) {
+			return TCL_ERROR;
+		}
+
+		res.clear();
+		reserve(obj, res);
+		for (; !done; Tcl_DictObjNext(&search, &key, &value, &done)) {
+			cast_value<K> k;
+			cast_value<V> v;
+			if (tcl_cast<K>::convert(interp, key, k) != TCL_OK || tcl_cast<V>::convert(interp, value, v) != TCL_OK) {
+				Tcl_DictObjDone(&search);
+				return TCL_ERROR;
+			}
+			res.emplace(std::move(k), std::move(v));
+		}
+
+		return TCL_OK;
+	}
+
+  private:
+	static void reserve(Tcl_Obj *, std::map<K, V> &) {}
+	static void reserve(Tcl_Obj *obj, std::unordered_map<K, V> &res) {
+		Tcl_Size n;
+		if (Tcl_DictObjSize(0, obj, &n) == TCL_OK) {
+			res.reserve(n);
+		}
+	}
+};
+
+template <typename K, typename V> struct tcl_cast<std::map<K, V>> : tcl_cast_dict<std::map<K, V>> {};
+
+template <typename K, typename V> struct tcl_cast<std::unordered_map<K, V>> : tcl_cast_dict<std::unordered_map<K, V>> {};
+
+// dict results are built with Tcl_DictObjPut
+// (Tcl has no way to size the dict up front)
+
+template <class M> Tcl_Obj *make_dict_obj(M const &m) {
+	Tcl_Obj *res = Tcl_NewDictObj();
+	for (typename M::const_iterator it = m.begin(); it != m.end(); ++it) {
+		Tcl_DictObjPut(0, res, make_obj(it->first), make_obj(it->second));
+	}
+
+	return res;
+}
+
+template <typename K, typename V> Tcl_Obj *make_obj(std::map<K, V> const &m) { return make_dict_obj(m); }
+
+template <typename K, typename V> Tcl_Obj *make_obj(std::unordered_map<K, V> const &m) { return make_dict_obj(m); }
+
+template <typename K, typename V> void set_result(Tcl_Interp *interp, std::map<K, V> const &m) { Tcl_SetObjResult(interp, make_obj(m)); }
+
+template <typename K, typename V> void set_result(Tcl_Interp *interp, std::unordered_map<K, V> const &m) { Tcl_SetObjResult(interp, make_obj(m)); }
+
+// structs
+
+template <class S> struct field_base {
+	explicit field_base(char const *name) : name_(name) {}
+	virtual ~field_base() {}
+
+	virtual int convert(Tcl_Interp *interp, Tcl_Obj *value, S &s) const = 0;
+	virtual Tcl_Obj *make(S const &s) const = 0;
+
+	std::string name_;
+};
+
+template <class S, typename F> struct struct_field : field_base<S> {
+	struct_field(char const *name, F S::*member) : field_base<S>(name), member_(member) {}
+
+	int convert(Tcl_Interp *interp, Tcl_Obj *value, S &s) const override { return tcl_cast<F>::convert(interp, value, s.*member_); }
+	Tcl_Obj *make(S const &s) const override { return make_obj(s.*member_); }
+
+	F S::*member_;
+};
+
+}
+
+// the description of a struct (see struct_type)
+template <class S> class struct_ {
+  public:
+	template <typename F> struct_ &field(char const *name, F S::*member) {
+		fields_.push_back(std::unique_ptr<details::field_base<S>>(new details::struct_field<S, F>(name, member)));
+		return *this;
+	}
+
+	std::vector<std::unique_ptr<details::field_base<S>>> const &fields() const { return fields_; }
+
+  private:
+	std::vector<std::unique_ptr<details::field_base<S>>> fields_;
+};
+
+namespace details {
+
+template <class S> struct struct_table {
+	static struct_<S> const &get() {
+		static struct_<S> const s = describe();
+		return s;
+	}
+
+	static struct_<S> describe() {
+		struct_<S> s;
+		struct_type<S>::describe(s);
+		return s;
+	}
+
+	// the key objects, one for each field
+	// - Tcl objects cannot be shared between threads, so each thread
+	//   has its own keys, released when Tcl finalizes the thread
+	static std::vector<Tcl_Obj *> const &keys() {
+		if (keys_ == 0) {
+			keys_ = new std::vector<Tcl_Obj *>;
+			for (auto const &f : get().fields()) {
+				keys_->push_back(make_obj(f->name_));
+				Tcl_IncrRefCount(keys_->back());
+			}
+			Tcl_CreateThreadExitHandler(release_keys, 0);
+		}
+		return *keys_;
+	}
+
+	static void release_keys(ClientData) {
+		for (Tcl_Obj *k : *keys_) {
+			Tcl_DecrRefCount(k);
+		}
+		delete keys_;
+		keys_ = 0;
+	}
+
+	static thread_local std::vector<Tcl_Obj *> *keys_;
+};
+
+template <class S> thread_local std::vector<Tcl_Obj *> *struct_table<S>::keys_ = 0;
+
+// the fields are looked up with the shared keys
+// - the dict still hashes the key string, but when it holds the same
+//   key object (a dict made by struct results of this thread) the
+//   entry is matched by pointer, without comparing the strings
+// - keys from other dicts (made by scripts, or with keys that were
+//   copied or created again) are matched by comparing the strings
+template <typename S> struct tcl_cast_struct {
+	static S from(Tcl_Interp *interp, Tcl_Obj *obj, bool = false) {
+		S res;
+		if (convert(interp, obj, res) != TCL_OK) {
+			throw tcl_error(interp);
+		}
+
+		return res;
+	}
+
+	static int convert(Tcl_Interp *interp, Tcl_Obj *obj, S &res) {
+		auto const &fields = struct_table<S>::get().fields();
+		std::vector<Tcl_Obj *> const &keys = struct_table<S>::keys();
+		for (std::size_t i = 0; i != fields.size(); ++i) {
+			Tcl_Obj *value;
+			if (Tcl_DictObjGet(interp, obj, keys[i], &value) != TCL_OK) {
+				return TCL_ERROR;
+			}
+			if (value == 0) {
+				if (interp != 0) {
+					Tcl_SetObjResult(interp, Tcl_ObjPrintf("missing field \"%s\"", fields[i]->name_.c_str()));
+				}
+				return TCL_ERROR;
+			}
+			if (fields[i]->convert(interp, value, res) != TCL_OK) {
+				return TCL_ERROR;
+			}
+		}
+
+		return TCL_OK;
+	}
+};
+
+template <typename S> typename std::enable_if<is_struct_type<S>::value, Tcl_Obj *>::type make_obj(S const &s) {
+	auto const &fields = struct_table<S>::get().fields();
+	std::vector<Tcl_Obj *> const &keys = struct_table<S>::keys();
+	Tcl_Obj *res = Tcl_NewDictObj();
+	for (std::size_t i = 0; i != fields.size(); ++i) {
+		Tcl_DictObjPut(0, res, keys[i], fields[i]->make(s));
+	}
+
+	return res;
+}
 
 }
 
@@ -11,25 +11,27 @@
 // Note: this file is not supposed to be a stand-alone header
 namespace Tcl { namespace details {
 
-template <class C, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7, typename T8, typename T9> struct get_callback_type_for_construct { typedef callback9<C *, T1, T2, T3, T4, T5, T6, T7, T8, T9> type; };
+// tells whether the last parameter gathers the remaining arguments
+// (the object const & parameter, see the variadic policy)
+template <typename... Ts> struct has_var_params : std::false_type {};
 
-template <class C, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7, typename T8> struct get_callback_type_for_construct<C, T1, T2, T3, T4, T5, T6, T7, T8, void> { typedef callback8<C *, T1, T2, T3, T4, T5, T6, T7, T8> type; };
+template <typename T> struct has_var_params<T> : std::is_same<T, object const &> {};
 
-template <class C, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6, typename T7> struct get_callback_type_for_construct<C, T1, T2, T3, T4, T5, T6, T7, void, void> { typedef callback7<C *, T1, T2, T3, T4, T5, T6, T7> type; };
+template <typename T, typename... Ts> struct has_var_params<T, Ts...> : has_var_params<Ts...> {};
 
-template <class C, typename T1, typename T2, typename T3, typename T4, typename T5, typename T6> struct get_callback_type_for_construct<C, T1, T2, T3, T4, T5, T6, void, void, void> { typedef callback6<C *, T1, T2, T3, T4, T5, T6> type; };
+// gives the plain function type of the call operator of lambdas
+// and other function objects (M is the type of &F::operator())
+template <typename M> struct call_signature;
 
-template <class C, typename T1, typename T2, typename T3, typename T4, typename T5> struct get_callback_type_for_construct<C, T1, T2, T3, T4, T5, void, void, void, void> { typedef callback5<C *, T1, T2, T3, T4, T5> type; };
+template <class F, typename R, typename... Ts> struct call_signature<R (F::*)(Ts...)> { typedef R type(Ts...); };
 
-template <class C, typename T1, typename T2, typename T3, typename T4> struct get_callback_type_for_construct<C, T1, T2, T3, T4, void, void, void, void, void> { typedef callback4<C *, T1, T2, T3, T4> type; };
+template <class F, typename R, typename... Ts> struct call_signature<R (F::*)(Ts...) const> { typedef R type(Ts...); };
 
-template <class C, typename T1, typename T2, typename T3> struct get_callback_type_for_construct<C, T1, T2, T3, void, void, void, void, void, void> { typedef callback3<C *, T1, T2, T3> type; };
+template <class F, typename R, typename... Ts> struct call_signature<R (F::*)(Ts...) noexcept> { typedef R type(Ts...); };
 
-template <class C, typename T1, typename T2> struct get_callback_type_for_construct<C, T1, T2, void, void, void, void, void, void, void> { typedef callback2<C *, T1, T2> type; };
+template <class F, typename R, typename... Ts> struct call_signature<R (F::*)(Ts...) const noexcept> { typedef R type(Ts...); };
 
-template <class C, typename T1> struct get_callback_type_for_construct<C, T1, void, void, void, void, void, void, void, void> { typedef callback1<C *, T1> type; };
-
-template <class C> struct get_callback_type_for_construct<C, void, void, void, void, void, void, void, void, void> { typedef callback0<C *> type; };
+template <class F> using functor_signature = typename call_signature<decltype(&F::operator())>::type;
 
 }
 
@@ -11,6 +11,7 @@
 #define CPPTCL_NO_TCL_STUBS
 #include "cpptcl/cpptcl.h"
 #include <iostream>
+#include <stdint.h>
 #undef NDEBUG
 #include <assert.h>
 
@@ -22,6 +23,27 @@ int fun2(int i) { return i + 2; }
 int fun3(int const &i) { return i + 2; }
 int fun4(std::string const &s) { return s.size(); }
 int fun5(char const *s) { return std::string(s).size(); }
+int fun6(int a, int b, int c, int d, int e, int f, int g, int h, int k, int l, std::string const &m) { return a + b + c + d + e + f + g + h + k + l + static_cast<int>(m.size()); }
+int fun7() noexcept { return 7; }
+int fun8(int i, double d) noexcept { return i + static_cast<int>(d); }
+int64_t wfun1(int64_t a) { return a * 2; }
+uint64_t wfun2(uint64_t a) { return a; }
+uint32_t wfun3(uint32_t a, short b) { return a + b; }
+long long wfun6(long long a) { return a; }
+size_t wfun4(uint8_t a) { return a; }
+float wfun5(float f) { return f / 2; }
+std::string_view fun9(std::string_view s, std::string_view const &t) { return s.size() > t.size() ? s.substr(1) : t; }
+
+class Sum {
+  public:
+	Sum(int a, int b, int c, int d, int e, int f, int g, int h, int k, int l) : sum_(a + b + c + d + e + f + g + h + k + l) {}
+
+	int get() const { return sum_; }
+	int add(int a, int b, int c, int d, int e, int f, int g, int h, int k, int l) { return sum_ += a + b + c + d + e + f + g + h + k + l; }
+
+  private:
+	int sum_;
+};
 
 void test1() {
 	Tcl_Interp * interp = Tcl_CreateInterp();
@@ -68,6 +90,111 @@ void test1() {
 		assert(false);
 	} catch (std::exception const &) {
 	}
+
+	// there is no limit on the number of parameters
+	i.def("fun6", fun6);
+	ival = i.eval("fun6 1 2 3 4 5 6 7 8 9 10 abc");
+	assert(ival == 58);
+
+	try {
+		i.eval("fun6 1 2 3 4 5 6 7 8 9 10");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(e.what() == std::string("Too few arguments."));
+	}
+
+	i.class_<Sum>("Sum", init<int, int, int, int, int, int, int, int, int, int>()).def("get", &Sum::get).def("add", &Sum::add);
+	ival = i.eval("set s [Sum 1 2 3 4 5 6 7 8 9 10]; $s add 1 1 1 1 1 1 1 1 1 1; set v [$s get]; $s -delete; set v");
+	assert(ival == 65);
+
+	i.eval("proc add3 {a b c} { expr {$a + $b + $c} }");
+	Bind<int, int, int, int> add3("add3");
+	assert(add3(1, 2, 3) == 6);
+
+	// functions given as template arguments get their own command procedure
+	i.def<fun0>("tfun0");
+	i.def<&fun2>("tfun2");
+	i.def<&fun4>("tfun4");
+	i.def<fun7>("tfun7");
+
+	i.eval("tfun0");
+	ival = i.eval("tfun2 7");
+	assert(ival == 9);
+	ival = i.eval("tfun4 Maciej");
+	assert(ival == 6);
+	ival = i.eval("tfun7");
+	assert(ival == 7);
+
+	static_assert(details::trampoline<fun7>::nothrow, "no exception handling for noexcept calls");
+	static_assert(!details::trampoline<fun2>::nothrow, "the function can throw");
+	static_assert(details::trampoline<fun8>::nothrow, "conversion errors are reported without exceptions");
+
+	try {
+		i.eval("tfun2");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(e.what() == std::string("Too few arguments."));
+	}
+
+	try {
+		i.eval("tfun2 notaninteger");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(std::string(e.what()).find("notaninteger") != std::string::npos);
+	}
+
+	// string views refer to the strings of the arguments
+	i.def("fun9", fun9);
+	std::string sval = i.eval("fun9 abcd ef");
+	assert(sval == "bcd");
+	sval = static_cast<std::string>(i.eval("fun9 a {x y}"));
+	assert(sval == "x y");
+
+	// the whole integer and floating-point family
+	i.def("wfun1", wfun1);
+	i.def("wfun2", wfun2);
+	i.def("wfun3", wfun3);
+	i.def("wfun4", wfun4);
+	i.def("wfun5", wfun5);
+	i.def("wfun6", wfun6);
+	sval = static_cast<std::string>(i.eval("wfun1 4000000000000"));
+	assert(sval == "8000000000000");
+	sval = static_cast<std::string>(i.eval("wfun2 18446744073709551615"));
+	assert(sval == "18446744073709551615");
+	ival = i.eval("expr {[wfun2 18446744073709551615] > 0}");
+	assert(ival == 1);
+	sval = static_cast<std::string>(i.eval("wfun3 4294967290 5"));
+	assert(sval == "4294967295");
+	ival = i.eval("wfun4 255");
+	assert(ival == 255);
+	dval = i.eval("wfun5 3.0");
+	assert(dval == 1.5);
+	sval = static_cast<std::string>(i.eval("wfun6 -9223372036854775808"));
+	assert(sval == "-9223372036854775808");
+	sval = static_cast<std::string>(i.eval("wfun6 [expr {2**63 - 1}]"));
+	assert(sval == "9223372036854775807");
+
+	for (char const *cmd : {"wfun2 -1", "wfun3 4294967296 0", "wfun3 1 40000", "wfun4 256", "wfun4 -1", "wfun5 1e300", "wfun2 18446744073709551616", "wfun6 18446744073709551615", "wfun6 9223372036854775808", "wfun6 -9223372036854775809", "wfun6 [expr {2**63}]", "wfun3 1 18446744073709551615", "wfun1 18446744073709551615", "fun2 4294967295", "fun2 2147483648", "fun2 -2147483649"}) {
+		try {
+			i.eval(cmd);
+			assert(false);
+		} catch (tcl_error const &) {
+		}
+	}
+
+	// bad arguments give the Tcl error messages
+	i.def<fun8>("tfun8");
+	i.def("fun8", fun8);
+	ival = i.eval("tfun8 1 2.5");
+	assert(ival == 3);
+	for (char const *cmd : {"tfun8 1 x", "fun8 1 x"}) {
+		try {
+			i.eval(cmd);
+			assert(false);
+		} catch (tcl_error const &e) {
+			assert(e.what() == std::string("expected floating-point number but got \"x\""));
+		}
+	}
 }
 
 int main() {
@@ -0,0 +1,483 @@
+//
+// Copyright (C) 2004-2006, Maciej Sobczak
+// Copyright (C) 2017-2019, FlightAware LLC
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+
+#define CPPTCL_NO_TCL_STUBS
+#include "cpptcl/cpptcl.h"
+#include <iostream>
+#include <string.h>
+#undef NDEBUG
+#include <assert.h>
+
+using namespace Tcl;
+
+double sum(std::vector<double> const &v) {
+	double s = 0;
+	for (double d : v) {
+		s += d;
+	}
+	return s;
+}
+
+std::vector<int> range(int n) {
+	std::vector<int> v;
+	for (int k = 0; k != n; ++k) {
+		v.push_back(k);
+	}
+	return v;
+}
+
+std::vector<std::string> words(std::vector<std::string> v) {
+	v.push_back("end");
+	return v;
+}
+
+std::array<double, 2> swap2(std::array<double, 2> const &p) { return {p[1], p[0]}; }
+
+std::vector<std::vector<int>> nested(std::vector<std::vector<int>> const &v) { return v; }
+
+std::map<std::string, int> sorted(std::map<std::string, int> const &m) { return m; }
+
+int total(std::unordered_map<std::string, int> const &m) {
+	int t = 0;
+	for (auto const &kv : m) {
+		t += kv.second;
+	}
+	return t;
+}
+
+std::map<int, std::vector<int>> groups(int n) {
+	std::map<int, std::vector<int>> m;
+	for (int k = 0; k != n; ++k) {
+		m[k % 2].push_back(k);
+	}
+	return m;
+}
+
+std::tuple<int, std::string, double> divmod(int a, int b) { return std::make_tuple(a / b, "rem", static_cast<double>(a % b)); }
+
+std::pair<std::string, int> swap_pair(std::pair<int, std::string> const &p) { return {p.second, p.first}; }
+
+std::optional<int> find_index(std::vector<std::string> const &v, std::string const &s) {
+	for (std::size_t k = 0; k != v.size(); ++k) {
+		if (v[k] == s) {
+			return static_cast<int>(k);
+		}
+	}
+	return std::nullopt;
+}
+
+int or_default(std::optional<int> o) { return o.value_or(-1); }
+
+std::vector<std::pair<std::string, int>> pairs(std::map<std::string, int> const &m) { return {m.begin(), m.end()}; }
+
+int checksum(const_byte_span s) {
+	int sum = 0;
+	for (unsigned char b : s) {
+		sum += b;
+	}
+	return sum;
+}
+
+unsigned char const *viewed = 0;
+void view(const_byte_span s) { viewed = s.data(); }
+
+byte_span invert(byte_span s) {
+	for (unsigned char &b : s) {
+		b = static_cast<unsigned char>(~b);
+	}
+	return s;
+}
+
+byte_span iota(std::size_t n) {
+	byte_span s(n);
+	for (std::size_t k = 0; k != n; ++k) {
+		s[k] = static_cast<unsigned char>(k);
+	}
+	s.resize(n / 2);
+	return s;
+}
+
+result_writer report(int n) {
+	result_writer w;
+	w.reserve(n * 8);
+	for (int k = 0; k != n; ++k) {
+		w << "row " << k << ' ' << 0.5 * k << '\n';
+	}
+	return w;
+}
+
+result_writer hex(unsigned long long v) {
+	result_writer w;
+	char *p = w.extend(32);
+	int len = snprintf(p, 33, "0x%llx", v);
+	w.resize(len);
+	return w;
+}
+
+bool is_odd(int i) { return i % 2 != 0; }
+
+long twice(long i) { return 2 * i; }
+
+constant_string const ready("ready");
+constant_string const busy("busy");
+
+constant_string const &status(bool b) { return b ? ready : busy; }
+
+std::string echo(std::string const &s) { return s; }
+
+long long isum(std::vector<long long> const &v) {
+	long long s = 0;
+	for (long long i : v) {
+		s += i;
+	}
+	return s;
+}
+
+std::vector<int> ints(std::vector<int> v) { return v; }
+
+void test1() {
+	Tcl_Interp *interp = Tcl_CreateInterp();
+	interpreter i(interp, true);
+
+	i.def("sum", sum);
+	i.def("range", range);
+	i.def("words", words);
+	i.def("swap2", swap2);
+	i.def("nested", nested);
+
+	double d = i.eval("sum {1.5 2.5 3}");
+	assert(d == 7.0);
+	d = i.eval("sum {}");
+	assert(d == 0.0);
+
+	int res = i.eval("llength [range 10000]");
+	assert(res == 10000);
+	res = i.eval("lindex [range 10] 9");
+	assert(res == 9);
+
+	std::string s = i.eval("words {a {b c}}");
+	assert(s == "a {b c} end");
+
+	s = static_cast<std::string>(i.eval("swap2 {1.0 2.0}"));
+	assert(s == "2.0 1.0");
+
+	s = static_cast<std::string>(i.eval("nested {{1 2} {} 3}"));
+	assert(s == "{1 2} {} 3");
+
+	try {
+		i.eval("sum {1 x 3}");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(e.what() == std::string("expected floating-point number but got \"x\""));
+	}
+
+	try {
+		i.eval("swap2 {1 2 3}");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(e.what() == std::string("expected list of 2 elements but got 3"));
+	}
+
+	try {
+		i.eval("sum \"{a\"");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(std::string(e.what()).find("unmatched open brace") != std::string::npos);
+	}
+}
+
+void test2() {
+	Tcl_Interp *interp = Tcl_CreateInterp();
+	interpreter i(interp, true);
+
+	i.def("sorted", sorted);
+	i.def("total", total);
+	i.def("groups", groups);
+
+	std::string s = i.eval("sorted {b 2 a 1 c 3}");
+	assert(s == "a 1 b 2 c 3");
+	s = static_cast<std::string>(i.eval("sorted {}"));
+	assert(s.empty());
+
+	int res = i.eval("total [dict create x 1 y 2 z 3]");
+	assert(res == 6);
+
+	res = i.eval("dict get [sorted {b 2 a 1}] b");
+	assert(res == 2);
+
+	s = static_cast<std::string>(i.eval("groups 5"));
+	assert(s == "0 {0 2 4} 1 {1 3}");
+
+	try {
+		i.eval("total {a 1 b x}");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(e.what() == std::string("expected integer but got \"x\""));
+	}
+
+	try {
+		i.eval("total {a 1 b}");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(std::string(e.what()).find("missing value") != std::string::npos);
+	}
+}
+
+void test3() {
+	Tcl_Interp *interp = Tcl_CreateInterp();
+	interpreter i(interp, true);
+
+	i.def("divmod", divmod);
+	i.def("swap_pair", swap_pair);
+	i.def("find_index", find_index);
+	i.def("or_default", or_default);
+	i.def("pairs", pairs);
+
+	std::string s = i.eval("divmod 7 2");
+	assert(s == "3 rem 1.0");
+
+	s = static_cast<std::string>(i.eval("swap_pair {5 {a b}}"));
+	assert(s == "{a b} 5");
+
+	int res = i.eval("find_index {x y z} z");
+	assert(res == 2);
+	s = static_cast<std::string>(i.eval("find_index {x y z} w"));
+	assert(s.empty());
+
+	res = i.eval("or_default 7");
+	assert(res == 7);
+	res = i.eval("or_default {}");
+	assert(res == -1);
+
+	s = static_cast<std::string>(i.eval("pairs {b 2 a 1}"));
+	assert(s == "{a 1} {b 2}");
+
+	try {
+		i.eval("swap_pair {1 2 3}");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(e.what() == std::string("expected list of 2 elements but got 3"));
+	}
+
+	try {
+		i.eval("swap_pair {x y}");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(e.what() == std::string("expected integer but got \"x\""));
+	}
+
+	try {
+		i.eval("or_default x");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(e.what() == std::string("expected integer but got \"x\""));
+	}
+}
+
+void test4() {
+	Tcl_Interp *interp = Tcl_CreateInterp();
+	interpreter i(interp, true);
+
+	i.def("checksum", checksum);
+	i.def("view", view);
+	i.def("invert", invert);
+	i.def("iota", iota);
+
+	int res = i.eval("checksum [binary format c* {1 2 3 250}]");
+	assert(res == 256);
+	res = i.eval("checksum {}");
+	assert(res == 0);
+
+	// the parameter refers to the bytes of the argument
+	char const buf[] = {1, 2, 3};
+	std::vector<object> cmd = {object("view"), object(buf, sizeof(buf))};
+	i.eval(cmd.begin(), cmd.end());
+	Tcl_Size len;
+	assert(viewed == Tcl_GetByteArrayFromObj(cmd[1].get_object(), &len));
+
+	// the writes do not reach the shared argument
+	std::string s = i.eval("set x [binary format H* 01ff]; binary encode hex [invert $x]");
+	assert(s == "fe00");
+	s = static_cast<std::string>(i.eval("binary encode hex $x"));
+	assert(s == "01ff");
+
+	s = static_cast<std::string>(i.eval("binary encode hex [iota 8]"));
+	assert(s == "00010203");
+	res = i.eval("string length [iota 0]");
+	assert(res == 0);
+}
+
+void test5() {
+	Tcl_Interp *interp = Tcl_CreateInterp();
+	interpreter i(interp, true);
+
+	i.def("report", report);
+	i.def("hex", hex);
+
+	std::string s = i.eval("report 3");
+	assert(s == "row 0 0.0\nrow 1 0.5\nrow 2 1.0\n");
+
+	int res = i.eval("llength [split [string trim [report 100000]] \\n]");
+	assert(res == 100000);
+	s = static_cast<std::string>(i.eval("lindex [split [report 100000] \\n] 99999"));
+	assert(s == "row 99999 49999.5");
+
+	s = static_cast<std::string>(i.eval("hex 255"));
+	assert(s == "0xff");
+	res = i.eval("string length [report 0]");
+	assert(res == 0);
+
+	result_writer w;
+	w << -5 << ' ' << 18446744073709551615ull << ' ' << std::string("x");
+	assert(std::string(w.data(), w.size()) == "-5 18446744073709551615 x");
+}
+
+void test6() {
+	Tcl_Interp *interp = Tcl_CreateInterp();
+	interpreter i(interp, true);
+
+	i.def("is_odd", is_odd);
+	i.def("twice", twice);
+	i.def("status", status);
+	i.def("echo", echo);
+
+	// the results kept in variables are not changed by the later calls
+	std::string s = i.eval("set a [is_odd 3]; set b [is_odd 4]; set c [twice 100000]; set d [twice 7]; list $a $b $c $d [is_odd 5]");
+	assert(s == "1 0 200000 14 1");
+
+	s = static_cast<std::string>(i.eval("set n 0; for {set k 0} {$k < 1000} {incr k} { incr n [is_odd $k] }; set n"));
+	assert(s == "500");
+
+	// constants are shared
+	s = static_cast<std::string>(i.eval("set x [status 1]; set y [status 1]; set z [status 0]; list $x $y $z"));
+	assert(s == "ready ready busy");
+	assert(Tcl_GetVar2Ex(interp, "x", 0, 0) == Tcl_GetVar2Ex(interp, "y", 0, 0));
+
+	// the result can be returned again as a string
+	s = static_cast<std::string>(i.eval("echo [echo abc]"));
+	assert(s == "abc");
+	s = static_cast<std::string>(i.eval("set r [echo xyz]; echo $r"));
+	assert(s == "xyz");
+
+	// the cache is per interpreter
+	{
+		interpreter i2(Tcl_CreateInterp(), true);
+		i2.def("status", status);
+		s = static_cast<std::string>(i2.eval("list [status 1] [status 0]"));
+		assert(s == "ready busy");
+	}
+	s = static_cast<std::string>(i.eval("status 0"));
+	assert(s == "busy");
+}
+
+void test7() {
+	Tcl_Interp *interp = Tcl_CreateInterp();
+	interpreter i(interp, true);
+
+	i.def("sum", sum);
+	i.def("isum", isum);
+	i.def("ints", ints);
+
+	// plain strings are parsed without making the list
+	double d = i.eval("set s [join {1.5 -2 3e2 .25} \" \"]; sum $s");
+	assert(d == 299.75);
+	std::string s = i.eval("tcl::unsupported::representation $s");
+	assert(s.find("value is a string") == 0);
+
+	s = static_cast<std::string>(i.eval("isum [string trim \"\n 9000000000\t-1  2 \"]"));
+	assert(s == "9000000001");
+	s = static_cast<std::string>(i.eval("ints [join {1 -2 0 -0} \" \"]"));
+	assert(s == "1 -2 0 0");
+
+	// the numbers that Tcl reads in its own way are left to Tcl
+	int same = i.eval("expr {[isum [join {017 0x1f +3} \" \"]] == 017 + 0x1f + 3}");
+	assert(same == 1);
+	same = i.eval("expr {[sum [join {1e999 Inf} \" \"]] == Inf}");
+	assert(same == 1);
+	d = i.eval("sum [join {{ 1} \"2\" \\x33} \" \"]");
+	assert(d == 6.0);
+
+	try {
+		i.eval("ints [join {1 4294967295} \" \"]");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(e.what() == std::string("integer value too large to represent"));
+	}
+
+	try {
+		i.eval("isum [join {1 2x} \" \"]");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(e.what() == std::string("expected integer but got \"2x\""));
+	}
+}
+
+void test8() {
+	Tcl_Interp *interp = Tcl_CreateInterp();
+	interpreter i(interp, true);
+
+	// the same strings as Tcl_PrintDouble
+	std::vector<double> values = {0.0, -0.0, 1.0, 0.5, 100.0, 1e15, 1e16, 1e17, 1.5e17, 1e-5, 0.001, 0.0001, 0.00012, 123.456, 1e300, 5e-324, 12345678901234567.0, 1.0 / 3, -2.2250738585072014e-308, 1.0 / 0.0, -1.0 / 0.0};
+	unsigned long long bits = 88172645463325252ULL;
+	for (int k = 0; k != 100000; ++k) {
+		bits ^= bits << 13;
+		bits ^= bits >> 7;
+		bits ^= bits << 17;
+		double d;
+		memcpy(&d, &bits, sizeof(d));
+		if (d == d) {
+			values.push_back(d);
+		}
+		values.push_back(static_cast<double>(bits % 1000000) / 1000);
+	}
+	for (double d : values) {
+		char expected[TCL_DOUBLE_SPACE];
+		char buf[TCL_DOUBLE_SPACE];
+		Tcl_PrintDouble(0, d, expected);
+		int len = details::format_double(d, buf);
+		assert(std::string(buf) == expected);
+		assert(len == static_cast<int>(strlen(expected)));
+	}
+
+	i.def("half", [](double d) { return d / 2; });
+	i.def("halves", [](std::vector<double> v) {
+		for (double &d : v) {
+			d /= 2;
+		}
+		return v;
+	});
+
+	std::string s = i.eval("half 3");
+	assert(s == "1.5");
+	s = static_cast<std::string>(i.eval("set h [half 1e40]; expr {$h * 2}"));
+	assert(s == "1e+40");
+	s = static_cast<std::string>(i.eval("halves {1 3 1e-10 -7}"));
+	assert(s == "0.5 1.5 5e-11 -3.5");
+	double d = i.eval("lindex [halves {1 3 5}] 2");
+	assert(d == 2.5);
+	s = static_cast<std::string>(i.eval("halves {}"));
+	assert(s.empty());
+}
+
+int main() {
+	try {
+		test1();
+		test2();
+		test3();
+		test4();
+		test5();
+		test6();
+		test7();
+		test8();
+	} catch (std::exception const &e) {
+		std::cerr << "Error: " << e.what() << '\n';
+		exit(-1);
+	}
+}
@@ -0,0 +1,327 @@
+//
+// Copyright (C) 2004-2006, Maciej Sobczak
+// Copyright (C) 2017-2019, FlightAware LLC
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+
+#define CPPTCL_NO_TCL_STUBS
+#include "cpptcl/cpptcl.h"
+#include <iostream>
+#undef NDEBUG
+#include <assert.h>
+
+using namespace Tcl;
+
+// small value, stored in the Tcl object
+struct position {
+	float lat;
+	float lon;
+};
+
+// larger value, allocated on the heap
+struct box {
+	double x0, y0, x1, y1;
+};
+
+int parsed = 0;
+int formatted = 0;
+
+namespace Tcl {
+
+template <> struct value_type<position> {
+	static constexpr char const *name = "position";
+
+	static std::string format(position const &p) {
+		++formatted;
+		std::ostringstream ss;
+		ss << p.lat << ' ' << p.lon;
+		return ss.str();
+	}
+
+	static int parse(Tcl_Interp *interp, Tcl_Obj *obj, position &res) {
+		++parsed;
+		std::array<float, 2> a;
+		if (details::tcl_cast<std::array<float, 2>>::convert(interp, obj, a) != TCL_OK) {
+			return TCL_ERROR;
+		}
+		res.lat = a[0];
+		res.lon = a[1];
+		return TCL_OK;
+	}
+};
+
+template <> struct value_type<box> {
+	static constexpr char const *name = "box";
+
+	static std::string format(box const &b) {
+		++formatted;
+		std::ostringstream ss;
+		ss << b.x0 << ' ' << b.y0 << ' ' << b.x1 << ' ' << b.y1;
+		return ss.str();
+	}
+
+	static int parse(Tcl_Interp *interp, Tcl_Obj *obj, box &res) {
+		++parsed;
+		std::array<double, 4> a;
+		if (details::tcl_cast<std::array<double, 4>>::convert(interp, obj, a) != TCL_OK) {
+			return TCL_ERROR;
+		}
+		res = box{a[0], a[1], a[2], a[3]};
+		return TCL_OK;
+	}
+};
+
+}
+
+enum class phase { taxi, climb, cruise, descent };
+
+namespace Tcl {
+
+template <> struct enum_type<phase> {
+	static constexpr char const *name = "phase";
+	static constexpr enum_value<phase> values[] = {{"taxi", phase::taxi}, {"climb", phase::climb}, {"cruise", phase::cruise}};
+};
+
+}
+
+struct waypoint {
+	std::string name;
+	double lat;
+	double lon;
+	std::vector<int> altitudes;
+};
+
+namespace Tcl {
+
+template <> struct struct_type<waypoint> {
+	static void describe(struct_<waypoint> &s) { s.field("name", &waypoint::name).field("lat", &waypoint::lat).field("lon", &waypoint::lon).field("altitudes", &waypoint::altitudes); }
+};
+
+}
+
+static_assert(details::value_obj_type<position>::in_place, "small values are kept in the object");
+static_assert(!details::value_obj_type<box>::in_place, "large values are allocated");
+
+box make_box(double x0, double y0, double x1, double y1) { return box{x0, y0, x1, y1}; }
+
+box grow(box const &b, double d) { return box{b.x0 - d, b.y0 - d, b.x1 + d, b.y1 + d}; }
+
+double width(box b) { return b.x1 - b.x0; }
+
+bool contains(box const &b, position p) { return p.lon >= b.x0 && p.lon <= b.x1 && p.lat >= b.y0 && p.lat <= b.y1; }
+
+position center(box const &b) { return position{static_cast<float>((b.y0 + b.y1) / 2), static_cast<float>((b.x0 + b.x1) / 2)}; }
+
+std::vector<box> split(box const &b) {
+	double m = (b.x0 + b.x1) / 2;
+	return {box{b.x0, b.y0, m, b.y1}, box{m, b.y0, b.x1, b.y1}};
+}
+
+phase next(phase p) { return static_cast<phase>(static_cast<int>(p) + 1); }
+
+bool airborne(phase p) { return p != phase::taxi; }
+
+std::vector<phase> phases() { return {phase::taxi, phase::cruise}; }
+
+void test1() {
+	Tcl_Interp *interp = Tcl_CreateInterp();
+	interpreter i(interp, true);
+
+	i.def("make_box", make_box);
+	i.def("grow", grow);
+	i.def("width", width);
+	i.def("contains", contains);
+	i.def("center", center);
+	i.def("split", split);
+
+	// the value is passed on without parsing or formatting
+	double d = i.eval("set b [make_box 0 0 10 20]; width [grow [grow $b 1] 2]");
+	assert(d == 16.0);
+	int res = i.eval("contains $b [center $b]");
+	assert(res == 1);
+	assert(parsed == 0);
+	assert(formatted == 0);
+
+	// the string form is made on demand, once
+	std::string s = i.eval("set b");
+	assert(s == "0 0 10 20");
+	s = static_cast<std::string>(i.eval("list $b; set b"));
+	assert(s == "0 0 10 20");
+	assert(formatted == 1);
+
+	// values given as strings are parsed once
+	res = i.eval("set p {5 5}; expr {[contains $b $p] + [contains $b $p]}");
+	assert(res == 2);
+	assert(parsed == 1);
+	d = i.eval("width {1 2 4 8}");
+	assert(d == 3.0);
+	assert(parsed == 2);
+
+	// value types nest in the other conversions
+	s = static_cast<std::string>(i.eval("split $b"));
+	assert(s == "{0 0 5 20} {5 0 10 20}");
+
+	// the copies keep the value
+	d = i.eval("set c $b; append c {}; set b2 [lindex [list $b] 0]; width $b2");
+	assert(d == 10.0);
+
+	try {
+		i.eval("width {1 2 3}");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(e.what() == std::string("expected list of 4 elements but got 3"));
+	}
+
+	try {
+		i.eval("contains $b {a b}");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(e.what() == std::string("expected floating-point number but got \"a\""));
+	}
+}
+
+void test2() {
+	Tcl_Interp *interp = Tcl_CreateInterp();
+	interpreter i(interp, true);
+
+	i.def("next", next);
+	i.def("airborne", airborne);
+	i.def("phases", phases);
+
+	std::string s = i.eval("next taxi");
+	assert(s == "climb");
+	s = static_cast<std::string>(i.eval("next [next taxi]"));
+	assert(s == "cruise");
+
+	// values without a name are given as numbers
+	s = static_cast<std::string>(i.eval("next cruise"));
+	assert(s == "3");
+
+	int res = i.eval("set p cruise; expr {[airborne $p] + [airborne $p] + [airborne taxi]}");
+	assert(res == 2);
+
+	s = static_cast<std::string>(i.eval("phases"));
+	assert(s == "taxi cruise");
+
+	// the name objects are shared
+	i.eval("set a [next taxi]; set b [next taxi]");
+	assert(Tcl_GetVar2Ex(interp, "a", 0, 0) == Tcl_GetVar2Ex(interp, "b", 0, 0));
+
+	// also with the elements of lists
+	i.eval("set l [phases]; set c [next climb]");
+	Tcl_Obj *e;
+	Tcl_ListObjIndex(interp, Tcl_GetVar2Ex(interp, "l", 0, 0), 1, &e);
+	assert(e == Tcl_GetVar2Ex(interp, "c", 0, 0));
+
+	try {
+		i.eval("airborne cr");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(e.what() == std::string("bad phase \"cr\": must be taxi, climb, or cruise"));
+	}
+}
+
+waypoint make_waypoint(std::string const &name, double lat, double lon) { return waypoint{name, lat, lon, {}}; }
+
+waypoint climb_to(waypoint w, int alt) {
+	w.altitudes.push_back(alt);
+	return w;
+}
+
+double route_lat(std::vector<waypoint> const &route) {
+	double res = 0;
+	for (auto const &w : route) {
+		res += w.lat;
+	}
+	return res;
+}
+
+// the key object of the first field of a waypoint made in another thread
+Tcl_Obj *thread_key = 0;
+int thread_key_refs = 0;
+
+Tcl_ThreadCreateType waypoint_thread(ClientData) {
+	Tcl_Obj *o = details::make_obj(make_waypoint("x", 1, 2));
+	Tcl_IncrRefCount(o);
+
+	Tcl_DictSearch s;
+	int done;
+	Tcl_DictObjFirst(0, o, &s, &thread_key, 0, &done);
+	Tcl_DictObjDone(&s);
+
+	// kept alive here, to be checked after the thread has ended
+	Tcl_IncrRefCount(thread_key);
+	Tcl_DecrRefCount(o);
+	thread_key_refs = thread_key->refCount;
+
+	Tcl_ExitThread(0);
+	TCL_THREAD_CREATE_RETURN;
+}
+
+void test3() {
+	Tcl_Interp *interp = Tcl_CreateInterp();
+	interpreter i(interp, true);
+
+	i.def("make_waypoint", make_waypoint);
+	i.def("climb_to", climb_to);
+	i.def("route_lat", route_lat);
+
+	std::string s = i.eval("make_waypoint KSFO 37.5 -122.25");
+	assert(s == "name KSFO lat 37.5 lon -122.25 altitudes {}");
+	s = static_cast<std::string>(i.eval("climb_to [climb_to [make_waypoint KSFO 37.5 -122.25] 1000] 5000"));
+	assert(s == "name KSFO lat 37.5 lon -122.25 altitudes {1000 5000}");
+
+	// the keys can be in any order, other keys are ignored
+	s = static_cast<std::string>(i.eval("climb_to {altitudes {} lon 2 lat 1 name x note y} 10"));
+	assert(s == "name x lat 1.0 lon 2.0 altitudes 10");
+
+	double lat = i.eval("route_lat [list [make_waypoint a 1.5 0] [make_waypoint b 2 0] {name c lat 3 lon 0 altitudes {}}]");
+	assert(lat == 6.5);
+
+	// the results share the key objects
+	i.eval("set a [make_waypoint a 1 2]; set b [make_waypoint b 3 4]");
+	Tcl_DictSearch sa, sb;
+	Tcl_Obj *ka, *kb;
+	int done;
+	assert(Tcl_DictObjFirst(interp, Tcl_GetVar2Ex(interp, "a", 0, 0), &sa, &ka, 0, &done) == TCL_OK);
+	assert(Tcl_DictObjFirst(interp, Tcl_GetVar2Ex(interp, "b", 0, 0), &sb, &kb, 0, &done) == TCL_OK);
+	assert(ka == kb);
+	Tcl_DictObjDone(&sa);
+	Tcl_DictObjDone(&sb);
+
+	try {
+		i.eval("climb_to {name x lat 1 altitudes {}} 10");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(e.what() == std::string("missing field \"lon\""));
+	}
+
+	try {
+		i.eval("climb_to {name x lat 1 lon y altitudes {}} 10");
+		assert(false);
+	} catch (tcl_error const &) {
+	}
+
+	// the keys of a thread are released when it ends
+	Tcl_ThreadId id;
+	int rc;
+	assert(Tcl_CreateThread(&id, waypoint_thread, 0, TCL_THREAD_STACK_DEFAULT, TCL_THREAD_JOINABLE) == TCL_OK);
+	assert(Tcl_JoinThread(id, &rc) == TCL_OK);
+	assert(thread_key_refs == 2);
+	assert(thread_key->refCount == 1);
+}
+
+int main() {
+	try {
+		test1();
+		test2();
+		test3();
+	} catch (std::exception const &e) {
+		std::cerr << "Error: " << e.what() << '\n';
+		exit(-1);
+	}
+}
@@ -0,0 +1,143 @@
+//
+// Copyright (C) 2004-2006, Maciej Sobczak
+// Copyright (C) 2017-2019, FlightAware LLC
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+
+#define CPPTCL_NO_TCL_STUBS
+#include "cpptcl/cpptcl.h"
+#include <iostream>
+#undef NDEBUG
+#include <assert.h>
+
+using namespace Tcl;
+
+packed_array<double> series(int n) {
+	packed_array<double> a(n);
+	double *p = a.mutable_data();
+	for (int k = 0; k != n; ++k) {
+		p[k] = k * 0.5;
+	}
+	return a;
+}
+
+double const *last_data = 0;
+
+double total(packed_array<double> const &a) {
+	last_data = a.data();
+	double t = 0;
+	for (double d : a) {
+		t += d;
+	}
+	return t;
+}
+
+packed_array<double> scale(packed_array<double> a, double f) {
+	double *p = a.mutable_data();
+	for (std::size_t k = 0; k != a.size(); ++k) {
+		p[k] *= f;
+	}
+	return a;
+}
+
+packed_array<int64_t> ids(packed_array<int32_t> const &a) {
+	packed_array<int64_t> res(a.size());
+	for (std::size_t k = 0; k != a.size(); ++k) {
+		res.mutable_data()[k] = static_cast<int64_t>(a[k]) << 32;
+	}
+	return res;
+}
+
+std::size_t count(packed_array<float> a) { return a.size(); }
+
+void test1() {
+	Tcl_Interp *interp = Tcl_CreateInterp();
+	interpreter i(interp, true);
+
+	i.def("series", series);
+	i.def("total", total);
+	i.def("scale", scale);
+	i.def("ids", ids);
+	i.def("count", count);
+	i.packed_commands();
+
+	// the string form is made on demand
+	std::string s = i.eval("series 4");
+	assert(s == "0.0 0.5 1.0 1.5");
+
+	// the same buffer is passed on
+	double d = i.eval("set a [series 100000]; total $a");
+	assert(d == 0.5 * 99999 * 100000 / 2);
+	double const *first = last_data;
+	d = i.eval("total $a");
+	assert(last_data == first);
+
+	// writes do not change the shared argument
+	d = i.eval("set b [scale $a 2]; total $b");
+	assert(d == 99999.0 * 100000 / 2);
+	d = i.eval("total $a");
+	assert(d == 0.5 * 99999 * 100000 / 2);
+
+	// lists are converted once
+	d = i.eval("set l {1 2 3.5}; total $l");
+	assert(d == 6.5);
+	s = static_cast<std::string>(i.eval("set l"));
+	assert(s == "1 2 3.5");
+
+	s = static_cast<std::string>(i.eval("ids {1 2}"));
+	assert(s == "4294967296 8589934592");
+
+	int res = i.eval("count [packed::float {1 2 3}]");
+	assert(res == 3);
+
+	// the commands
+	res = i.eval("packed::length $a");
+	assert(res == 100000);
+	d = i.eval("packed::index $a 99999");
+	assert(d == 49999.5);
+	s = static_cast<std::string>(i.eval("packed::index $a 100000"));
+	assert(s.empty());
+	s = static_cast<std::string>(i.eval("packed::slice $a 1 3"));
+	assert(s == "0.5 1.0 1.5");
+	d = i.eval("total [packed::slice $a -5 2]");
+	assert(d == 1.5);
+	s = static_cast<std::string>(i.eval("packed::slice $a 5 2"));
+	assert(s.empty());
+	s = static_cast<std::string>(i.eval("packed::slice [packed::int32 {7 8 9}] 1 2"));
+	assert(s == "8 9");
+
+	// ordinary lists work too
+	res = i.eval("packed::length {a b c}");
+	assert(res == 3);
+	s = static_cast<std::string>(i.eval("packed::index {a b c} 1"));
+	assert(s == "b");
+	s = static_cast<std::string>(i.eval("packed::slice {a b c} 1 5"));
+	assert(s == "b c");
+
+	try {
+		i.eval("total {1 x}");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(e.what() == std::string("expected floating-point number but got \"x\""));
+	}
+
+	try {
+		i.eval("packed::int32 {1 2.5}");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(e.what() == std::string("expected integer but got \"2.5\""));
+	}
+}
+
+int main() {
+	try {
+		test1();
+	} catch (std::exception const &e) {
+		std::cerr << "Error: " << e.what() << '\n';
+		exit(-1);
+	}
+}
@@ -10,6 +10,7 @@
 
 #define CPPTCL_NO_TCL_STUBS
 #include "cpptcl/cpptcl.h"
+#include <functional>
 #include <iostream>
 #include <sstream>
 #undef NDEBUG
@@ -60,6 +61,17 @@ void use(C *p) { p->fun0(); }
 
 void sinkFun(C *p) { delete p; }
 
+class D {};
+
+class CD : public C {
+  public:
+	CD() : C(7) {}
+};
+
+CD *makeCD() { return new CD; }
+
+void killCD(CD *p) { delete p; }
+
 void test1() {
 	Tcl_Interp * interp = Tcl_CreateInterp();
 	interpreter i(interp, true);
@@ -150,9 +162,246 @@ void test1() {
 	assert(objNum == 0);
 }
 
+void test2() {
+	Tcl_Interp * interp = Tcl_CreateInterp();
+	interpreter i(interp, true);
+
+	i.class_<C>("C");
+	i.def("use", use);
+	i.def("sink", sinkFun, sink(1));
+	i.def("makeCD", makeCD);
+	i.def("killCD", killCD);
+
+	i.eval("set p [C]");
+	std::string s = i.eval("set p");
+	assert(s[0] == 'p');
+
+	// handles rebuilt from their string form are accepted
+	i.eval("use [string range \" $p \" 1 end-1]");
+	assert(did == "C::fun0() on 1");
+
+	// handles of derived classes are accepted
+	i.eval("set d [makeCD]");
+	i.eval("use $d");
+	assert(did == "C::fun0() on 2");
+	i.eval("killCD $d");
+
+	// pointers of types that are not classes are accepted as strings,
+	// also when no other Tcl value refers to them
+	i.eval("set d [format %s [makeCD]]");
+	assert(objNum == 2);
+	i.eval("killCD $d");
+	assert(objNum == 1);
+
+	try {
+		i.eval("use notapointer");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(e.what() == std::string("Expected pointer value."));
+	}
+
+	// handles of deleted objects are rejected
+	i.eval("set q $p");
+	i.eval("sink $p");
+	assert(objNum == 0);
+	try {
+		i.eval("use $q");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(std::string(e.what()).find("was deleted") != std::string::npos);
+	}
+
+	// also when the handle is rebuilt from its string form
+	try {
+		i.eval("use [format %s $q]");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(std::string(e.what()).find("does not exist") != std::string::npos);
+	}
+}
+
+class E {
+  public:
+	int add(int a, int b) { return a + b; }
+	int sub(int a, int b) { return a - b; }
+};
+
+void test3() {
+	Tcl_Interp * interp = Tcl_CreateInterp();
+	interpreter i(interp, true);
+
+	details::class_definer<E> e = i.class_<E>("E").def("calc", &E::add);
+
+	i.eval("proc calc {o n} { set s 0; for {set k 0} {$k < $n} {incr k} { incr s [$o calc $k 1] }; return $s }");
+	i.eval("set e [E]");
+	int res = i.eval("calc $e 4");
+	assert(res == 10);
+
+	// redefined methods are picked up by the cached method names
+	e.def("calc", &E::sub);
+	res = i.eval("calc $e 4");
+	assert(res == 2);
+
+	try {
+		i.eval("$e nosuchmethod");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(e.what() == std::string("Method nosuchmethod not found."));
+	}
+
+	try {
+		i.eval("$e");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(e.what() == std::string("Too few arguments."));
+	}
+
+	// large method tables
+	for (int k = 0; k != 70; ++k) {
+		std::ostringstream ss;
+		ss << "m" << k;
+		e.def(ss.str(), k % 2 == 0 ? &E::add : &E::sub);
+	}
+	res = i.eval("set s 0; for {set k 0} {$k < 70} {incr k} { incr s [$e m$k $k 1] }; set s");
+	assert(res == 70 * 69 / 2);
+
+	i.eval("$e -delete");
+}
+
+class F {
+  public:
+	F() : n_(0) {}
+
+	int n_;
+};
+
+void test4() {
+	Tcl_Interp * interp = Tcl_CreateInterp();
+	interpreter i(interp, true);
+
+	// lambdas and function objects keep their state in the command
+	int calls = 0;
+	std::string prefix = "id";
+	i.def("next", [&calls, prefix](int k) { ++calls; return prefix + std::to_string(k); });
+	i.def("count", [n = 0]() mutable { return ++n; });
+	i.def("twice", std::function<int(int)>([](int k) { return 2 * k; }));
+
+	std::string s = i.eval("next 5");
+	assert(s == "id5");
+	assert(calls == 1);
+	i.eval("count; count");
+	int res = i.eval("count");
+	assert(res == 3);
+	res = i.eval("twice 21");
+	assert(res == 42);
+
+	// methods take the object as the first parameter
+	int step = 2;
+	i.class_<F>("F")
+	    .def("incr", [step](F &f, int k) { return f.n_ += k * step; })
+	    .def("get", [](F const *f) { return f->n_; });
+
+	res = i.eval("set f [F]; $f incr 3; $f incr 1; $f get");
+	assert(res == 8);
+	i.eval("$f -delete");
+}
+
+class G {
+  public:
+	G(int id) : id_(id), alt_(0) {}
+
+	int id() const { return id_; }
+	void climb(int by, int times) { alt_ += by * times; }
+	int alt() const { return alt_; }
+
+  private:
+	int id_;
+	int alt_;
+};
+
+G *makeG(int id) { return new G(id); }
+
+struct Base {
+	int base_ = 1;
+};
+
+struct Derived : Base {
+	int get() const { return 42; }
+};
+
+Base *as_base(Derived *d) { return d; }
+
+void test5() {
+	Tcl_Interp * interp = Tcl_CreateInterp();
+	interpreter i(interp, true);
+
+	i.handle_class_<G>("G", init<int>()).def("id", &G::id).def("climb", &G::climb).def("alt", &G::alt);
+	i.def("makeG", makeG, factory("G"));
+	i.class_<D>("D");
+
+	// the objects do not get their own commands
+	int commands = i.eval("llength [info commands]");
+	i.eval("set g [G new 7]; G climb $g 100 3; set h [makeG 8]");
+	int res = i.eval("llength [info commands]");
+	assert(res == commands);
+
+	res = i.eval("G id $g");
+	assert(res == 7);
+	res = i.eval("G alt $g");
+	assert(res == 300);
+	res = i.eval("G id $h");
+	assert(res == 8);
+
+	try {
+		i.eval("G alt");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(e.what() == std::string("Too few arguments."));
+	}
+
+	try {
+		i.eval("G alt [D]");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(std::string(e.what()).find("wrong type") != std::string::npos);
+	}
+
+	i.eval("G -delete $g; G -delete $h");
+	try {
+		i.eval("G alt $g");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(std::string(e.what()).find("was deleted") != std::string::npos);
+	}
+
+	try {
+		i.eval("G alt [format %s $h]");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(std::string(e.what()).find("does not exist") != std::string::npos);
+	}
+
+	// results of base class pointers do not change the type of the handle
+	i.handle_class_<Derived>("Derived", init<>()).def("get", &Derived::get);
+	i.def("as_base", as_base);
+	i.eval("set h [Derived new]");
+	res = i.eval("Derived get $h");
+	assert(res == 42);
+	i.eval("as_base $h");
+	res = i.eval("Derived get $h");
+	assert(res == 42);
+	res = i.eval("Derived get [format %s $h]");
+	assert(res == 42);
+	i.eval("Derived -delete $h");
+}
+
 int main() {
 	try {
 		test1();
+		test2();
+		test3();
+		test4();
+		test5();
 	} catch (std::exception const &e) {
 		std::cerr << "Error: " << e.what() << '\n';
 	}
@@ -17,6 +17,7 @@
 using namespace Tcl;
 
 int fun() { return 7; }
+int fun8() { return 8; }
 
 void test1() {
 	Tcl_Interp * interp = Tcl_CreateInterp();
@@ -40,10 +41,34 @@ void test2() {
 	assert(ret == 7);
 }
 
+void test3() {
+	Tcl_Interp * interp = Tcl_CreateInterp();
+	interpreter i(interp, true);
+
+	// renamed and redefined commands keep their own callbacks
+	i.def("fun", fun);
+	i.eval("rename fun fun7");
+	i.def("fun", fun8);
+
+	int ret = i.eval("fun7");
+	assert(ret == 7);
+	ret = i.eval("fun");
+	assert(ret == 8);
+
+	i.def("fun", fun);
+	ret = i.eval("fun");
+	assert(ret == 7);
+
+	i.eval("rename fun {}");
+	ret = i.eval("fun7");
+	assert(ret == 7);
+}
+
 int main() {
 	try {
 		test1();
 		test2();
+		test3();
 	} catch (std::exception const &e) {
 		std::cerr << "Error: " << e.what() << '\n';
 	}
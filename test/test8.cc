@@ -0,0 +1,81 @@
+//
+// Copyright (C) 2004-2006, Maciej Sobczak
+// Copyright (C) 2017-2019, FlightAware LLC
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+
+#define CPPTCL_NO_TCL_STUBS
+#include "cpptcl/cpptcl.h"
+#include <iostream>
+#undef NDEBUG
+#include <assert.h>
+
+using namespace Tcl;
+
+void test1() {
+	Tcl_Interp *interp = Tcl_CreateInterp();
+	interpreter i(interp, true);
+
+	// the script is evaluated after the command returns
+	i.def("down", [&i](int n) {
+		if (n > 0) {
+			i.tail_eval(object("rec " + std::to_string(n - 1)));
+		}
+		return n;
+	}, nre());
+	i.eval("proc rec {n} { down $n }");
+
+	int res = i.eval("down 5");
+	assert(res == 0);
+
+	// deep recursion through C++ does not grow the C stack
+	i.eval("interp recursionlimit {} 1000000");
+	res = i.eval("rec 100000");
+	assert(res == 0);
+
+	// the continuation gets the result of the script
+	i.def("answer", [&i]() { i.tail_eval(object("expr {6 * 7}"), [&i](object const &r) { return r.get<int>(i) + 1; }); }, nre());
+	res = i.eval("answer");
+	assert(res == 43);
+
+	// errors in the script are propagated
+	i.def("fail", [&i]() { i.tail_eval(object("error oops"), [](object const &) { assert(false); }); }, nre());
+	try {
+		i.eval("fail");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(e.what() == std::string("oops"));
+	}
+
+	// commands can yield from coroutines through the tail evaluation
+	i.def("nyield", [&i](std::string const &v) { i.tail_eval(object("yield " + v)); }, nre());
+	i.eval("proc gen {} { nyield a; nyield b; return done }");
+	std::string s = i.eval("coroutine c gen");
+	assert(s == "a");
+	s = static_cast<std::string>(i.eval("c"));
+	assert(s == "b");
+	s = static_cast<std::string>(i.eval("c"));
+	assert(s == "done");
+
+	// tail evaluation needs the nre policy
+	i.def("plain", [&i]() { i.tail_eval(object("set x 1")); });
+	try {
+		i.eval("plain");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(e.what() == std::string("Tail evaluation is possible only in commands defined with the nre policy."));
+	}
+}
+
+int main() {
+	try {
+		test1();
+	} catch (std::exception const &e) {
+		std::cerr << "Error: " << e.what() << '\n';
+		exit(-1);
+	}
+}
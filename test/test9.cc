@@ -0,0 +1,97 @@
+//
+// Copyright (C) 2004-2006, Maciej Sobczak
+// Copyright (C) 2017-2019, FlightAware LLC
+//
+// Permission to copy, use, modify, sell and distribute this software
+// is granted provided this copyright notice appears in all copies.
+// This software is provided "as is" without express or implied
+// warranty, and with no claim as to its suitability for any purpose.
+//
+
+#define CPPTCL_NO_TCL_STUBS
+#include "cpptcl/cpptcl.h"
+#include <iostream>
+#undef NDEBUG
+#include <assert.h>
+
+using namespace Tcl;
+
+int deleted = 0;
+
+class Counter {
+  public:
+	Counter(int start) : n_(start) {}
+	~Counter() { ++deleted; }
+
+	void add(int k) { n_ += k; }
+	int get() const { return n_; }
+
+  private:
+	int n_;
+};
+
+void test1() {
+	Tcl_Interp *interp = Tcl_CreateInterp();
+	interpreter i(interp, true);
+
+	i.oo_class_<Counter>("Counter", init<int>()).def("add", &Counter::add).def("get", &Counter::get);
+
+	int res = i.eval("set c [Counter new 5]; $c add 3; $c get");
+	assert(res == 8);
+
+	res = i.eval("Counter create cc 1; cc add 1; cc get");
+	assert(res == 2);
+
+	// objects are deleted with the destroy method
+	i.eval("$c destroy");
+	assert(deleted == 1);
+
+	// classes can be extended in Tcl
+	i.eval("oo::class create Twice { superclass Counter; method twice {} { my add [my get]; my get } }");
+	res = i.eval("[Twice new 2] twice");
+	assert(res == 4);
+
+	i.eval("oo::class create Ten { superclass Counter; constructor {} { next 10 } }");
+	res = i.eval("[Ten new] get");
+	assert(res == 10);
+
+	i.eval("oo::class create Double { superclass Counter; method add {k} { next [expr {2 * $k}] } }");
+	res = i.eval("set d [Double new 0]; $d add 3; $d get");
+	assert(res == 6);
+
+	try {
+		i.eval("$d add");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(std::string(e.what()).find("wrong # args") != std::string::npos);
+	}
+
+	try {
+		i.eval("cc add");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(e.what() == std::string("Too few arguments."));
+	}
+
+	// the constructor of the C++ class must be called
+	i.eval("oo::class create Bad { superclass Counter; constructor {} { variable x 1 } }");
+	try {
+		i.eval("[Bad new] get");
+		assert(false);
+	} catch (tcl_error const &e) {
+		assert(e.what() == std::string("Object has no C++ instance."));
+	}
+
+	deleted = 0;
+}
+
+int main() {
+	try {
+		test1();
+		// the remaining objects are deleted together with the interpreter
+		assert(deleted == 4);
+	} catch (std::exception const &e) {
+		std::cerr << "Error: " << e.what() << '\n';
+		exit(-1);
+	}
+}